@@ -0,0 +1,36 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+
+/*
+ * Serial bootloader (src/boot/bootloader.c), built with [env:bootloader].
+ *
+ * BOOT_SIZE is the flash reserved for the bootloader at address 0. It must
+ * equal FUSE.BOOTSIZE * 256 and the application's .text link offset; 0
+ * builds the application for a bare device with no bootloader.
+ */
+#ifndef BOOT_SIZE
+#define BOOT_SIZE 0
+#endif
+
+// Bootloader serial rate, reached by running at the full 20MHz
+#ifndef BOOT_BAUD
+#define BOOT_BAUD 115200UL
+#endif
+
+/*
+ * Frames from the host: command byte, payload, then CRC-16/XMODEM of the
+ * command and payload, high byte first so the CRC over the whole frame is
+ * zero. Multi-byte payload fields are low byte first. Each frame is
+ * answered with BOOT_ACK or BOOT_NAK.
+ */
+#define BOOT_CMD_IDENTIFY 'I'   // Reply: ACK, page size, BOOT_SIZE / 256
+#define BOOT_CMD_PAGE     'P'   // Payload: address (2 bytes), one flash page
+#define BOOT_CMD_VERIFY   'V'   // Payload: image length (2), image CRC (2)
+#define BOOT_CMD_GO       'G'   // Start the application
+
+#define BOOT_ACK 'K'
+#define BOOT_NAK 'N'
+
+#endif // BOOT_H
@@ -9,8 +9,25 @@
 #define min_frequency -3
 #define scaling_factor 3
 
+/*
+ * Dual-voice audio (-DDUAL_VOICE=1): TCA0 runs in split mode as two 8-bit
+ * tone generators, voice 0 on PB0 (WO0, the buzzer) and voice 1 on PA3
+ * (WO3; mix into the buzzer through a resistor or fit a second one).
+ * buzzer_on()/buzzer_off() drive voice 0.
+ */
+#ifndef DUAL_VOICE
+#define DUAL_VOICE 0
+#endif
+
+#if DUAL_VOICE && ((SYMBOL_BUTTON_MASK) & 0x08)
+#error "SYMBOL_BUTTON_MASK must not contain PA3 (voice 1) with DUAL_VOICE"
+#endif
+
+// Pitch shift applied to all notes (min_frequency to max_frequency)
+extern volatile int8_t frequency;
+
 // The array declaration
-extern const uint32_t base_periods[4];
+extern const uint32_t base_periods[NOTE_COUNT];
 
 // Function declarations
 void buzzer_on(const Note note);
@@ -18,5 +35,17 @@ void buzzer_off(void);
 void decrease_frequency(void);
 void increase_frequency(void);
 uint32_t period_map(Note note);
+void voice_on(uint8_t voice, Note note);
+void voice_off(uint8_t voice);
+void buzzer_retune(void);
+
+#if DUAL_VOICE
+void buzzer_chord(Note low, Note high);
+void buzzer_chord_off(void);
+#else
+/* Jingles stay silent with a single voice */
+static inline void buzzer_chord(Note low, Note high) { (void)low; (void)high; }
+static inline void buzzer_chord_off(void) {}
+#endif
 
 #endif  // BUZZER_H
\ No newline at end of file
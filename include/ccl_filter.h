@@ -0,0 +1,46 @@
+#ifndef CCL_FILTER_H
+#define CCL_FILTER_H
+
+#include <avr/io.h>
+#include <stdint.h>
+#include "reaction.h"
+
+/*
+ * Hardware glitch filter on the buttons (-DCCL_FILTER=1).
+ *
+ * PA4-PA7 are routed through EVSYS channels 0-3 into CCL LUT0-3, each a
+ * pass-through of its event input with the synchroniser and filter on.
+ * The filter takes four samples of the 1.024kHz oscillator, so a level
+ * must hold for four periods (about 3.9ms) before it reaches the LUT
+ * output, and the LUT falling-edge interrupt then flags a clean press in
+ * GPIOR3. The 5ms debounce tick
+ * only confirms that the pin is still low and accepts the press at once,
+ * instead of waiting out four samples; releases keep the software
+ * vertical counter.
+ *
+ * The timed mode needs EVSYS channel 0 for its capture, so the two
+ * cannot be combined.
+ */
+#ifndef CCL_FILTER
+#define CCL_FILTER 0
+#endif
+
+#if CCL_FILTER && REACTION_MODE
+#error "CCL_FILTER uses EVSYS channel 0, which REACTION_MODE needs"
+#endif
+
+// Buttons routed through the CCL (one LUT each)
+#define CCL_FILTER_PINS (PIN4_bm | PIN5_bm | PIN6_bm | PIN7_bm)
+
+#if CCL_FILTER
+
+void ccl_filter_init(void);
+
+#else
+
+/* Hooks compile away completely when the mode is disabled */
+static inline void ccl_filter_init(void) {}
+
+#endif
+
+#endif // CCL_FILTER_H
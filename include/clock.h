@@ -0,0 +1,191 @@
+// clock.h - Clock profile selection and derived peripheral timings
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include "notes.h"
+#include "buzzer.h"
+
+/*
+ * The clock profile is chosen by F_CPU (board_build.f_cpu in platformio.ini).
+ * The main clock is OSC20M divided by the CLKCTRL prescaler; every timer
+ * period, the baud rate, the ADC clock and the tone table below are derived
+ * from it at compile time, and out-of-range values stop the build.
+ */
+#ifndef F_CPU
+#define F_CPU 3333333UL
+#endif
+
+#if F_CPU == 20000000
+#define CLOCK_MCLKCTRLB 0                                      // No prescaler
+#elif F_CPU == 10000000
+#define CLOCK_MCLKCTRLB (CLKCTRL_PDIV_2X_gc | CLKCTRL_PEN_bm)
+#elif F_CPU == 5000000
+#define CLOCK_MCLKCTRLB (CLKCTRL_PDIV_4X_gc | CLKCTRL_PEN_bm)
+#elif F_CPU == 3333333
+#define CLOCK_MCLKCTRLB (CLKCTRL_PDIV_6X_gc | CLKCTRL_PEN_bm)  // Reset default
+#elif F_CPU == 2500000
+#define CLOCK_MCLKCTRLB (CLKCTRL_PDIV_8X_gc | CLKCTRL_PEN_bm)
+#elif F_CPU == 2000000
+#define CLOCK_MCLKCTRLB (CLKCTRL_PDIV_10X_gc | CLKCTRL_PEN_bm)
+#elif F_CPU == 1250000
+#define CLOCK_MCLKCTRLB (CLKCTRL_PDIV_16X_gc | CLKCTRL_PEN_bm)
+#elif F_CPU == 1000000
+#define CLOCK_MCLKCTRLB (CLKCTRL_PDIV_24X_gc | CLKCTRL_PEN_bm)
+#else
+#error "Unsupported F_CPU: must be 20MHz divided by 1, 2, 4, 6, 8, 10, 16 or 24"
+#endif
+
+/*
+ * Clock governor (-DCLOCK_GOVERNOR=1, see clock_governor.c): the core
+ * drops to F_CPU >> CLOCK_IDLE_SHIFT while waiting and can rise to
+ * F_CPU << CLOCK_BOOST_SHIFT for compute-heavy work. Levels differ by
+ * powers of two so the tone clock is kept exact by the TCA0 prescaler.
+ * Peripherals that are set once (TCB clock, ADC) are sized for the
+ * fastest level and checked at the slowest.
+ */
+#ifndef CLOCK_GOVERNOR
+#define CLOCK_GOVERNOR 0
+#endif
+
+#if CLOCK_GOVERNOR
+#ifndef CLOCK_IDLE_SHIFT
+#define CLOCK_IDLE_SHIFT 2      // 833kHz idle at the default 3.33MHz
+#endif
+#ifndef CLOCK_BOOST_SHIFT
+#define CLOCK_BOOST_SHIFT 0     // No faster power-of-two step from 3.33MHz
+#endif
+#else
+#define CLOCK_IDLE_SHIFT 0
+#define CLOCK_BOOST_SHIFT 0
+#endif
+
+#define CLOCK_MIN_HZ (F_CPU >> CLOCK_IDLE_SHIFT)
+#define CLOCK_MAX_HZ (F_CPU << CLOCK_BOOST_SHIFT)
+
+// OSC20M divisor giving a clock, and the MCLKCTRLB value for it
+#define CLOCK_DIVISOR(hz) ((20000000UL + (hz) / 2) / (hz))
+#define CLOCK_DIVISOR_VALID(d) ((d) == 1 || (d) == 2 || (d) == 4 || (d) == 6 ||   \
+                                (d) == 8 || (d) == 10 || (d) == 12 || (d) == 16 || \
+                                (d) == 24 || (d) == 32 || (d) == 48 || (d) == 64)
+#define CLOCK_PDIV(d)                                                     \
+    ((d) == 1 ? 0 :                                                       \
+     ((d) == 2 ? CLKCTRL_PDIV_2X_gc : (d) == 4 ? CLKCTRL_PDIV_4X_gc :     \
+      (d) == 6 ? CLKCTRL_PDIV_6X_gc : (d) == 8 ? CLKCTRL_PDIV_8X_gc :     \
+      (d) == 10 ? CLKCTRL_PDIV_10X_gc : (d) == 12 ? CLKCTRL_PDIV_12X_gc : \
+      (d) == 16 ? CLKCTRL_PDIV_16X_gc : (d) == 24 ? CLKCTRL_PDIV_24X_gc : \
+      (d) == 32 ? CLKCTRL_PDIV_32X_gc : (d) == 48 ? CLKCTRL_PDIV_48X_gc : \
+      CLKCTRL_PDIV_64X_gc) | CLKCTRL_PEN_bm)
+
+#if CLOCK_GOVERNOR && (!CLOCK_DIVISOR_VALID(CLOCK_DIVISOR(CLOCK_MIN_HZ)) || \
+                       !CLOCK_DIVISOR_VALID(CLOCK_DIVISOR(CLOCK_MAX_HZ)) || \
+                       CLOCK_MAX_HZ > 20000000)
+#error "Clock governor levels must be 20MHz divided by a CLKCTRL prescaler"
+#endif
+
+/* ---- TCB timers: 1ms system tick and 5ms multiplex tick ---- */
+
+// TCB clock is halved when a 5ms period would not fit in 16 bits
+#if (CLOCK_MAX_HZ / 200) > 65536
+#define TIMER_TCB_DIV 2
+#define TIMER_TCB_CLKSEL TCB_CLKSEL_DIV2_gc
+#else
+#define TIMER_TCB_DIV 1
+#define TIMER_TCB_CLKSEL TCB_CLKSEL_DIV1_gc
+#endif
+
+// Periodic mode counts 0..CCMP, so the period is CCMP + 1 cycles
+#define TIMER_TICK_CCMP_AT(hz) (((hz) / TIMER_TCB_DIV + 500) / 1000 - 1)
+// Exactly five ticks, keeping display dimming in phase with multiplexing
+#define TIMER_MUX_CCMP_AT(hz) (5 * (TIMER_TICK_CCMP_AT(hz) + 1) - 1)
+
+#define TIMER_TICK_CCMP TIMER_TICK_CCMP_AT(F_CPU)
+#define TIMER_MUX_CCMP TIMER_MUX_CCMP_AT(F_CPU)
+
+#if TIMER_MUX_CCMP_AT(CLOCK_MAX_HZ) > 65535 || TIMER_TICK_CCMP_AT(CLOCK_MIN_HZ) < 100
+#error "TCB periods out of range for this F_CPU"
+#endif
+
+/* ---- USART0 ---- */
+
+#ifndef UART_BAUD
+#define UART_BAUD 9600
+#endif
+
+// Normal mode: BAUD = 64 * F_CPU / (16 * rate), rounded
+#define UART_BAUD_VALUE_AT(hz) ((4 * (hz) + UART_BAUD / 2) / UART_BAUD)
+#define UART_BAUD_ACTUAL_AT(hz) ((4 * (hz)) / UART_BAUD_VALUE_AT(hz))
+#define UART_BAUD_ERROR_AT(hz) (UART_BAUD_ACTUAL_AT(hz) > UART_BAUD ?      \
+                                UART_BAUD_ACTUAL_AT(hz) - UART_BAUD :      \
+                                UART_BAUD - UART_BAUD_ACTUAL_AT(hz))
+
+#define UART_BAUD_VALUE UART_BAUD_VALUE_AT(F_CPU)
+
+#if UART_BAUD_VALUE_AT(CLOCK_MIN_HZ) < 64 || UART_BAUD_VALUE_AT(CLOCK_MAX_HZ) > 65535
+#error "UART_BAUD out of range for this F_CPU or clock governor level"
+#endif
+#if UART_BAUD_ERROR_AT(CLOCK_MIN_HZ) * 50 > UART_BAUD || UART_BAUD_ERROR_AT(CLOCK_MAX_HZ) * 50 > UART_BAUD
+#error "UART_BAUD error above 2% for this F_CPU or clock governor level"
+#endif
+
+/* ---- ADC0 ---- */
+
+// Keep CLK_ADC at or below 2MHz, at the fastest clock level
+#if CLOCK_MAX_HZ <= 4000000
+#define ADC_PRESC ADC_PRESC_DIV2_gc
+#elif CLOCK_MAX_HZ <= 8000000
+#define ADC_PRESC ADC_PRESC_DIV4_gc
+#elif CLOCK_MAX_HZ <= 16000000
+#define ADC_PRESC ADC_PRESC_DIV8_gc
+#else
+#define ADC_PRESC ADC_PRESC_DIV10_gc
+#endif
+
+// CLK_PER cycles per microsecond, rounded up (longer at slower levels)
+#define ADC_TIMEBASE_VALUE ((CLOCK_MAX_HZ + 999999) / 1000000)
+
+#if ADC_TIMEBASE_VALUE > 31
+#error "ADC timebase out of range for this F_CPU"
+#endif
+
+/* ---- TCA0 tone generation ---- */
+
+// Period in TCA0 cycles for a note given in centihertz
+#define TONE_CYCLES(div, chz) (((F_CPU / (div)) * 100 + (chz) / 2) / (chz))
+// Longest period: lowest note at the lowest octave setting
+#define TONE_FITS(div) ((TONE_CYCLES(div, NOTE_LOWEST_CHZ) << (0 - (min_frequency))) <= 65535)
+
+// Smallest prescaler that keeps every note within the 16-bit period
+#if TONE_FITS(1)
+#define TONE_DIV 1
+#define TONE_CLKSEL TCA_SINGLE_CLKSEL_DIV1_gc
+#elif TONE_FITS(2)
+#define TONE_DIV 2
+#define TONE_CLKSEL TCA_SINGLE_CLKSEL_DIV2_gc
+#elif TONE_FITS(4)
+#define TONE_DIV 4
+#define TONE_CLKSEL TCA_SINGLE_CLKSEL_DIV4_gc
+#elif TONE_FITS(8)
+#define TONE_DIV 8
+#define TONE_CLKSEL TCA_SINGLE_CLKSEL_DIV8_gc
+#elif TONE_FITS(16)
+#define TONE_DIV 16
+#define TONE_CLKSEL TCA_SINGLE_CLKSEL_DIV16_gc
+#else
+#error "No TCA0 prescaler fits the tone table for this F_CPU"
+#endif
+
+// Shortest period: highest note at the highest octave setting
+#if (TONE_CYCLES(TONE_DIV, NOTE_HIGHEST_CHZ) >> (max_frequency)) < 16
+#error "Tone resolution too coarse for this F_CPU"
+#endif
+
+// Governor levels move the TCA0 prescaler with the clock (DIV1 to DIV16)
+#if CLOCK_GOVERNOR && !DUAL_VOICE && \
+    ((TONE_DIV >> CLOCK_IDLE_SHIFT) < 1 || (TONE_DIV << CLOCK_BOOST_SHIFT) > 16)
+#error "No TCA0 prescaler keeps the tones exact at these clock governor shifts"
+#endif
+
+// Tone table entry: octave-0 period scaled up by scaling_factor
+#define TONE_PERIOD(chz) ((uint32_t)TONE_CYCLES(TONE_DIV, chz) << scaling_factor)
+
+#endif // CLOCK_H
@@ -0,0 +1,82 @@
+#ifndef CLOCK_GOVERNOR_H
+#define CLOCK_GOVERNOR_H
+
+#include <stdint.h>
+#include "clock.h"
+#include "reaction.h"
+#include "link.h"
+#include "irq.h"
+
+/*
+ * Clock governor (-DCLOCK_GOVERNOR=1, levels set in clock.h): waits for
+ * ticks or input run at CLOCK_IDLE, the rest of the main loop at
+ * CLOCK_ACTIVE (F_CPU) and the ":gen" bench at CLOCK_BOOST. Each switch
+ * rescales TCB0/TCB1, USART0 and TCA0 so ticks, baud and tones are the
+ * same at every level. ":clock" reports the time spent at each level and
+ * an energy estimate from CLOCK_SUPPLY_MV, CLOCK_UA_STATIC and
+ * CLOCK_UA_PER_MHZ (typical ATtiny1626 figures; measure a board to
+ * calibrate them).
+ */
+typedef enum {
+    CLOCK_IDLE,
+    CLOCK_ACTIVE,
+    CLOCK_BOOST,
+    CLOCK_LEVELS
+} clock_level_t;
+
+#if CLOCK_GOVERNOR && REACTION_MODE
+#error "CLOCK_GOVERNOR cannot be combined with REACTION_MODE (capture ticks follow CLK_PER)"
+#endif
+#if CLOCK_GOVERNOR && IRQ_LATENCY
+#error "CLOCK_GOVERNOR cannot be combined with IRQ_LATENCY (latency is counted in CLK_PER)"
+#endif
+#if CLOCK_GOVERNOR && VERSUS_MODE
+#error "CLOCK_GOVERNOR cannot be combined with VERSUS_MODE (a link byte could be lost at a switch)"
+#endif
+
+#ifndef CLOCK_SUPPLY_MV
+#define CLOCK_SUPPLY_MV 3300
+#endif
+#ifndef CLOCK_UA_STATIC
+#define CLOCK_UA_STATIC 150     // OSC20M and the running peripherals
+#endif
+#ifndef CLOCK_UA_PER_MHZ
+#define CLOCK_UA_PER_MHZ 260    // Active core current per MHz at 3V
+#endif
+
+#if CLOCK_GOVERNOR
+
+extern clock_level_t clock_level;
+
+void clock_set(clock_level_t level);
+void clock_report(void);
+
+// Current level's clock as a shift from F_CPU (negative when slower)
+static inline int8_t clock_shift(void) {
+    return clock_level == CLOCK_IDLE ? -CLOCK_IDLE_SHIFT :
+           clock_level == CLOCK_BOOST ? CLOCK_BOOST_SHIFT : 0;
+}
+
+// CLK_PER in kHz at the current level
+static inline uint16_t clock_khz(void) {
+    return clock_level == CLOCK_IDLE ? CLOCK_MIN_HZ / 1000 :
+           clock_level == CLOCK_BOOST ? CLOCK_MAX_HZ / 1000 : F_CPU / 1000;
+}
+
+#else
+
+/* Hooks compile away completely when the mode is disabled */
+static inline void clock_set(clock_level_t level) { (void)level; }
+static inline void clock_report(void) {}
+static inline int8_t clock_shift(void) { return 0; }
+static inline uint16_t clock_khz(void) { return F_CPU / 1000; }
+
+#endif
+
+// Converts a count of F_CPU cycles to CLK_PER cycles at the current level
+static inline uint32_t clock_cycles(uint32_t cycles) {
+    int8_t shift = clock_shift();
+    return shift < 0 ? cycles >> -shift : cycles << shift;
+}
+
+#endif // CLOCK_GOVERNOR_H
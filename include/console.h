@@ -0,0 +1,27 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdint.h>
+
+// Character that opens a command line on the UART
+#define CONSOLE_PROMPT ':'
+
+// Receive ring size (power of two) and longest command line
+#define CONSOLE_RX_SIZE 16
+#define CONSOLE_LINE_SIZE 24
+
+// Run-time counters reported by the "stats" command
+typedef struct {
+    uint16_t games;         // Games started
+    uint16_t rounds;        // Rounds completed successfully
+    uint16_t presses;       // Button presses accepted (hardware or UART)
+    uint8_t rx_overflows;   // Console characters dropped
+} console_counters_t;
+
+extern console_counters_t counters;
+extern volatile uint8_t console_active;
+
+void console_receive(char c);
+void console_poll(void);
+
+#endif // CONSOLE_H
@@ -1,14 +1,33 @@
+#ifndef DISPLAY_H
+#define DISPLAY_H
+
 #include <stdint.h>
 
-extern volatile uint8_t left_byte;
-extern volatile uint8_t right_byte;
+/*
+ * Double-buffered display frames. Writers compose the back frame and
+ * commit it; the multiplex ISR flips front and back only before a left
+ * digit, so a left/right pair always comes from one complete frame.
+ */
+typedef struct {
+    uint8_t left;    // Left digit, DISP_LHS included
+    uint8_t right;   // Right digit
+} display_frame_t;
+
+extern volatile display_frame_t display_frames[2];
+
+// Brightness in ms lit per 5ms multiplex slot (0 = off, 5 = always on)
+#define DISPLAY_BRIGHTNESS_MAX 5
+extern volatile uint8_t display_brightness;
+extern volatile uint8_t display_lit_ticks;
 
 // Segment display hexadecimal values for digits
 extern const uint8_t segments[11];
 
 
+#define DISP_SEG_A 0b01011111
 #define DISP_SEG_B 0b01101111
 #define DISP_SEG_C 0b01111011
+#define DISP_SEG_D 0b01111101
 #define DISP_SEG_E 0b01111110
 #define DISP_SEG_F 0b00111111
 
@@ -17,6 +36,9 @@ extern const uint8_t segments[11];
 
 #define DISP_OFF 0b01111111
 
+// display_digit() step that blanks both digits
+#define DISP_STEP_OFF 0xFF
+
 #define DISP_LHS (1 << 7)
 
 #define PATTERN_SUCCESS_LEFT  0x00  // Binary: 00000000
@@ -34,4 +56,4 @@ typedef enum {
 void update_display(const uint8_t left, const uint8_t right);
 void display_digit(uint8_t step);
 
-void extract_digits(uint32_t number, uint8_t *left_digit, uint8_t *right_digit);
\ No newline at end of file
+#endif // DISPLAY_H
@@ -0,0 +1,68 @@
+#ifndef ENDURANCE_H
+#define ENDURANCE_H
+
+#include <stdint.h>
+#include "lsfr.h"
+#include "replay.h"
+#include "link.h"
+
+/*
+ * Endurance mode (-DENDURANCE_INTERVAL=n): every n levels the generator
+ * state and score are checkpointed, and each round plays and checks only
+ * the steps since the last checkpoint. Rounds stay at most n steps long,
+ * so games can run to thousands of steps. After a failure the player can
+ * resume from the checkpoint: S1 resumes, any other button starts afresh.
+ * One checkpoint is kept and restored directly, so memory is bounded and
+ * resuming takes constant time. 0 disables the mode.
+ */
+#ifndef ENDURANCE_INTERVAL
+#define ENDURANCE_INTERVAL 0
+#endif
+
+#if ENDURANCE_INTERVAL && REPLAY_MODE
+#error "ENDURANCE_INTERVAL cannot be combined with REPLAY_MODE (resumed games have no seed)"
+#endif
+#if ENDURANCE_INTERVAL && VERSUS_MODE
+#error "ENDURANCE_INTERVAL cannot be combined with VERSUS_MODE"
+#endif
+
+// Result of endurance_choice() at the START stage
+typedef enum {
+    ENDURANCE_WAIT,     // Checkpoint offered, no choice made yet
+    ENDURANCE_FRESH,    // Start a new game from the seed
+    ENDURANCE_RESUME    // Continue from the checkpoint
+} endurance_choice_t;
+
+#if ENDURANCE_INTERVAL
+
+extern uint32_t endurance_start_state;
+extern uint16_t endurance_start_length;
+
+void endurance_reset(void);
+void endurance_checkpoint(uint16_t completed);
+endurance_choice_t endurance_choice(uint8_t pressed);
+uint16_t endurance_resume(void);
+void endurance_save(void);
+void endurance_load(void);
+
+// Generator state the current round starts from
+static inline uint32_t endurance_origin(void) { return endurance_start_state; }
+
+// Steps before the current round's first step
+static inline uint16_t endurance_offset(void) { return endurance_start_length; }
+
+#else
+
+/* Hooks compile away completely when the mode is disabled */
+static inline void endurance_reset(void) {}
+static inline void endurance_checkpoint(uint16_t completed) { (void)completed; }
+static inline endurance_choice_t endurance_choice(uint8_t pressed) { (void)pressed; return ENDURANCE_FRESH; }
+static inline uint16_t endurance_resume(void) { return 1; }
+static inline void endurance_save(void) {}
+static inline void endurance_load(void) {}
+static inline uint32_t endurance_origin(void) { return game.seed; }
+static inline uint16_t endurance_offset(void) { return 0; }
+
+#endif
+
+#endif // ENDURANCE_H
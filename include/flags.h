@@ -0,0 +1,28 @@
+#ifndef FLAGS_H
+#define FLAGS_H
+
+#include <avr/io.h>
+
+/*
+ * Hot-path flags and ISR state kept in the general purpose I/O registers.
+ *
+ * GPIOR0-3 are in the low I/O space, so a single bit compiles to one
+ * SBI/CBI (atomic, no working register) or is tested with SBIS/SBIC, and a
+ * whole register is read or written with a one-cycle IN/OUT instead of
+ * LDS/STS.
+ *
+ * GPIOR0: single-bit flags below
+ * GPIOR1, GPIOR2: debounce vertical counter (pb_debounce() in input.h)
+ * GPIOR3: presses filtered by the CCL, awaiting pb_debounce() (ccl_filter.h)
+ */
+#define FLAG_DISPLAY_SIDE  0   // Next multiplex write is the right digit
+                           // Bit 1 is free
+#define FLAG_INPUT_PENDING 2   // Debounced buttons changed since check_edge()
+#define FLAG_DISPLAY_FRONT 3   // Display frame being shown (display.h)
+#define FLAG_DISPLAY_COMMIT 4  // Back frame complete, flip at the next boundary
+
+#define flag_set(bit)   (GPIOR0 |= (1 << (bit)))
+#define flag_clear(bit) (GPIOR0 &= (uint8_t)~(1 << (bit)))
+#define flag_test(bit)  (GPIOR0 & (1 << (bit)))
+
+#endif // FLAGS_H
@@ -0,0 +1,53 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdint.h>
+#include "states_m.h"
+
+/*
+ * Game context: the round, press and sequence generator state that the
+ * main loop, input handling and generator share, kept in one block so it
+ * is addressed from a single base pointer and can be saved and restored
+ * whole. Debounce and edge state stay private to input.c.
+ *
+ * stage and button hold simon_stage and buttons values in one byte each.
+ * The flags are bitfields written only from the main loop; button_active
+ * is set by the UART RX ISR, so it is a whole volatile byte.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t stage;                   // simon_stage
+    uint8_t button;                  // buttons: COMPLETE or the press being held
+    uint8_t player_input : 1;        // A press has finished, check the round
+    uint8_t sequence_matched : 1;    // No mismatch yet this round
+    uint8_t pb_released : 1;         // Current press has been released
+    uint8_t pushbutton_received : 1; // Current press came from a button
+    volatile uint8_t button_active;  // Pin of a console or bot key press
+    uint16_t sequence_length;        // Steps in the current round
+    uint16_t sequence_position;      // Steps entered so far this round
+    uint32_t press_start;            // Tick the current press was accepted
+    uint32_t seed;                   // Sequence seed of the current game
+    uint32_t state_sequence;         // Sequence generator state
+    uint8_t step;                    // Latest generated step (symbol)
+    uint8_t result;                  // Latest generator output bit
+} game_t;
+
+extern game_t game;
+
+/**
+ * Returns the context through a base pointer register
+ *
+ * The empty asm hides the constant address, so GCC keeps it in Y or Z
+ * ("b") and reaches each member with one-word LDD/STD displacements
+ * instead of two-word LDS/STS. Use it in functions touching several
+ * members; single accesses are cheaper through game directly.
+ */
+static inline game_t *game_context(void) {
+    game_t *context = &game;
+    __asm__("" : "+b"(context));
+    return context;
+}
+
+void game_save(void);
+uint8_t game_load(void);
+
+#endif // GAME_H
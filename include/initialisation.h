@@ -1,16 +1,40 @@
+#ifndef INITIALISATION_H
+#define INITIALISATION_H
+
+#include "startup.h"
+
+void clock_init(void);
 void button_init(void);
 void pwm_init(void);
 void spi_init(void);
 void timers_init(void);
 void adc_init(void);
 void uart_init(void);
+void irq_init(void);
 
-#define INIT_ALL_SYSTEMS() \
-    do {                   \
-        adc_init();        \
-        button_init();     \
-        spi_init();        \
-        pwm_init();        \
-        timers_init();     \
-        uart_init();       \
+/*
+ * Start-up order: the time base first (it times the rest, see startup.h),
+ * then the ADC so its primed conversion runs while the remaining
+ * peripherals are set up and the first round can start on the first pass.
+ */
+#define INIT_ALL_SYSTEMS()                 \
+    do {                                   \
+        clock_init();                      \
+        startup_stamp(STARTUP_CLOCK);      \
+        timers_init();                     \
+        startup_stamp(STARTUP_TIMERS);     \
+        adc_init();                        \
+        startup_stamp(STARTUP_ADC);        \
+        button_init();                     \
+        startup_stamp(STARTUP_BUTTONS);    \
+        irq_init();                        \
+        startup_stamp(STARTUP_IRQ);        \
+        spi_init();                        \
+        startup_stamp(STARTUP_SPI);        \
+        pwm_init();                        \
+        startup_stamp(STARTUP_PWM);        \
+        uart_init();                       \
+        startup_stamp(STARTUP_UART);       \
     } while (0)
+
+#endif // INITIALISATION_H
@@ -3,6 +3,23 @@
 
 #include <avr/io.h>
 #include "states_m.h"
+#include "flags.h"
+#include "symbols.h"
+#include "game.h"
+#include "ccl_filter.h"
+#include "press_bench.h"
+
+/*
+ * Worst-case ms from a clean edge to its acceptance: four 5ms samples in
+ * software, or the CCL filter (about 3.9ms) plus the next sample.
+ * Releases are always debounced in software.
+ */
+#if CCL_FILTER
+#define PRESS_ACCEPT_MAX_MS 9
+#else
+#define PRESS_ACCEPT_MAX_MS 20
+#endif
+#define RELEASE_ACCEPT_MAX_MS 20
 
 // Type definitions
 typedef struct {
@@ -13,7 +30,6 @@ typedef struct {
 
 // Public function declarations
 void check_edge(void);
-void pb_debounce(void);
 void button_press(uint8_t button_index);
 
 // External variable declarations
@@ -23,14 +39,49 @@ extern volatile uint8_t pb_debounced_state;
 extern uint8_t pb_changed;
 extern uint8_t pb_falling;
 extern uint8_t pb_rising;
-extern volatile uint8_t button_active;
-extern uint8_t pb_released;
-extern uint8_t pushbutton_received;
 
-extern uint8_t player_input;
-extern uint8_t sequence_position;
-extern uint8_t sequence_matched;
+extern button_pin mapped_array[SYMBOL_COUNT];
+
+/**
+ * Debounces the buttons with a vertical counter (5ms ISR tick)
+ *
+ * Two counter bits per input, held in GPIOR1/GPIOR2 so each access is a
+ * single IN/OUT; a change is accepted after four consistent samples.
+ * Inlined into the timer ISRs to avoid a call and the full register save
+ * it forces. Flags FLAG_INPUT_PENDING when the debounced state changes.
+ * Only pins in SYMBOL_BUTTON_MASK are sampled.
+ *
+ * With CCL_FILTER, presses already filtered in hardware (GPIOR3) are
+ * accepted on the first sample that still reads the pin low.
+ */
+static inline void pb_debounce(void) {
+    uint8_t state = pb_debounced_state;
+    uint8_t input = PORTA.IN;
+
+#if CCL_FILTER
+    uint8_t confirmed = GPIOR3 & ~input & state;
+    GPIOR3 = 0;
+    if (confirmed) {
+        state ^= confirmed;
+        pb_debounced_state = state;
+        flag_set(FLAG_INPUT_PENDING);
+        press_bench_accepted(confirmed);
+    }
+#endif
+
+    uint8_t changed = (input ^ state) & SYMBOL_BUTTON_MASK;
+
+    uint8_t count0 = GPIOR1;
+    uint8_t count1 = (GPIOR2 ^ count0) & changed;
+    count0 = ~count0 & changed;
+    GPIOR1 = count0;
+    GPIOR2 = count1;
 
-extern button_pin mapped_array[4];
+    if (count0 & count1) {
+        pb_debounced_state = state ^ (count0 & count1);
+        flag_set(FLAG_INPUT_PENDING);
+        press_bench_accepted(count0 & count1 & state);  // Bits that went low
+    }
+}
 
 #endif // INPUT_H
\ No newline at end of file
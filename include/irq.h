@@ -0,0 +1,78 @@
+#ifndef IRQ_H
+#define IRQ_H
+
+#include <avr/io.h>
+#include <stdint.h>
+
+/*
+ * Interrupt priority plan (CPUINT), set up by irq_init():
+ *
+ * Level 1: TCB0_INT, the 1ms time base. It preempts any level 0 handler,
+ *          so a USART0 RX handler spinning in uart_putc() cannot delay
+ *          ticks or the playback timing derived from them.
+ * Level 0: everything else, in round-robin order so that display
+ *          multiplexing (TCB1_INT, SPI0_INT) and USART0_RXC each get a
+ *          turn under heavy UART traffic instead of losing to the lower
+ *          vector number every time.
+ *
+ * The level 1 handler must stay short and only touch state that is safe
+ * against a preempted level 0 handler (single-byte stores, SBI/CBI flags).
+ */
+
+/*
+ * Latency measurement (-DIRQ_LATENCY=1): each periodic timer handler reads
+ * its own counter on entry. The counter restarts when the interrupt flag is
+ * set, so the count is the time from flag to handler body, including the
+ * prologue. Each handler reads it again at the end of its body, so the
+ * worst time from flag to finished work (latency plus body, without the
+ * epilogue) is kept too. Both worst cases per vector are reported by
+ * ":irq".
+ */
+#ifndef IRQ_LATENCY
+#define IRQ_LATENCY 0
+#endif
+
+typedef enum {
+    IRQ_TCB0,       // 1ms tick (level 1)
+    IRQ_TCB1,       // 5ms multiplex tick (level 0, not in the timed mode)
+    IRQ_COUNT
+} irq_vector_t;
+
+void irq_init(void);
+
+#if IRQ_LATENCY
+
+extern volatile uint16_t irq_latency_max[IRQ_COUNT];
+extern volatile uint16_t irq_done_max[IRQ_COUNT];
+
+/**
+ * Records a latency sample in timer counts (call first thing in the ISR)
+ */
+static inline void irq_latency_sample(irq_vector_t vector, uint16_t count) {
+    if (count > irq_latency_max[vector]) {
+        irq_latency_max[vector] = count;
+    }
+}
+
+/**
+ * Records the count at the end of the handler body (call last in the ISR)
+ */
+static inline void irq_done_sample(irq_vector_t vector, uint16_t count) {
+    if (count > irq_done_max[vector]) {
+        irq_done_max[vector] = count;
+    }
+}
+
+void irq_latency_report(void);
+
+#else
+
+/* Hooks compile away completely when the mode is disabled; a macro, so
+ * the counter (a volatile register) is not read either */
+#define irq_latency_sample(vector, count) ((void)0)
+#define irq_done_sample(vector, count) ((void)0)
+static inline void irq_latency_report(void) {}
+
+#endif
+
+#endif // IRQ_H
@@ -0,0 +1,58 @@
+#ifndef LINK_H
+#define LINK_H
+
+#include <stdint.h>
+
+/*
+ * Head-to-head versus mode over USART0 (-DVERSUS_MODE=1).
+ *
+ * Link messages use bytes with the high bit set, so they share the line
+ * with ASCII console text and game keys. A message is one header byte,
+ * 0x80 | (type << 4) | nibble, followed by 7-bit payload bytes; the RX
+ * ISR claims the payload bytes by counting them off after each header.
+ * Once the first header has arrived all ASCII on the line is the peer's
+ * text output and is dropped, so the console and keymap only work over
+ * the serial port until a peer has been heard from.
+ */
+#ifndef VERSUS_MODE
+#define VERSUS_MODE 0
+#endif
+
+// Message types (header bits 6-4)
+#define LINK_SEED     0   // Nibble: seed bits 31-28; payload: seed (4 bytes), delay (2 bytes)
+#define LINK_READY    1   // Nibble: round number (sequence length, low 4 bits)
+#define LINK_PROGRESS 2   // Payload: correct steps so far this round, at most 99 (1 byte)
+#define LINK_FAIL     3   // Sender made a mistake and lost
+#define LINK_PING     4   // Round-trip probe
+#define LINK_PONG     5   // Reply to LINK_PING
+
+#define LINK_HEADER(type, nibble) (0x80 | ((type) << 4) | ((nibble) & 0x0F))
+
+// Bytes of payload following each header
+#define LINK_SEED_PAYLOAD 6
+#define LINK_PROGRESS_PAYLOAD 1
+
+#if VERSUS_MODE
+
+uint8_t link_receive(uint8_t byte);
+void link_poll(void);
+uint8_t link_game_ready(uint8_t pressed);
+uint8_t link_round_ready(uint16_t sequence_length);
+void link_progress(uint16_t position);
+void link_lost(void);
+uint8_t link_peer_lost(uint8_t playing);
+void link_ping(void);
+
+#else
+
+/* Hooks compile away completely when the mode is disabled */
+static inline void link_poll(void) {}
+static inline uint8_t link_game_ready(uint8_t pressed) { (void)pressed; return 1; }
+static inline uint8_t link_round_ready(uint16_t sequence_length) { (void)sequence_length; return 1; }
+static inline void link_progress(uint16_t position) { (void)position; }
+static inline void link_lost(void) {}
+static inline uint8_t link_peer_lost(uint8_t playing) { (void)playing; return 0; }
+
+#endif
+
+#endif // LINK_H
@@ -1,13 +1,36 @@
+#ifndef LSFR_H
+#define LSFR_H
+
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include "symbols.h"
+#include "game.h"
 
 // Mask defined as specified
 #define LSFR_MASK 0xE2024CABu
 
-extern uint32_t seed;
-extern uint32_t state_sequence;
-extern uint8_t step;
-extern uint8_t result;
+/* Sequence generator backends, selected at build time with -DSEQUENCE_GENERATOR=n */
+#define GEN_LFSR       0   // Galois LFSR, one shift per step (original)
+#define GEN_LFSR_MULTI 1   // Galois LFSR, SYMBOL_BITS shifts per step, output bits only
+#define GEN_XORSHIFT   2   // Marsaglia xorshift32, top bits
+#define GEN_COUNT      3
+
+#ifndef SEQUENCE_GENERATOR
+#define SEQUENCE_GENERATOR GEN_LFSR
+#endif
+
+// Generator step: advances state and produces a SYMBOL_BITS-bit draw
+typedef void (*sequence_generator_fn)(uint32_t *state, uint8_t *step, uint8_t *result);
+
+typedef struct {
+    const char *name;           // Backend name (in flash)
+    sequence_generator_fn next; // Step function
+} sequence_generator_t;
+
+extern const sequence_generator_t sequence_generators[GEN_COUNT];
 
 
 void SEQUENCE(uint32_t *state, uint8_t *step, uint8_t *result);
+void generator_bench(void);
+
+#endif // LSFR_H
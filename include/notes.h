@@ -2,13 +2,44 @@
 #ifndef NOTES_H
 #define NOTES_H
 
+#include "symbols.h"
 
 
+/* Note frequencies in centihertz, used to generate the tone table */
+#define NOTE_E_HIGH_CHZ  37012
+#define NOTE_C_SHARP_CHZ 31124
+#define NOTE_A_CHZ       49412
+#define NOTE_E_LOW_CHZ   18504
+
+/* Extra notes for symbols S5-S8 (SYMBOL_COUNT > 4) */
+#define NOTE_B_CHZ            24694
+#define NOTE_F_SHARP_CHZ      27718
+#define NOTE_G_SHARP_CHZ      41530
+#define NOTE_C_SHARP_HIGH_CHZ 55437
+
+// Tones in the table: the four base notes (also used by jingles) and S5-S8
+#if SYMBOL_COUNT > 4
+#define NOTE_COUNT SYMBOL_COUNT
+#else
+#define NOTE_COUNT 4
+#endif
+
+#define NOTE_LOWEST_CHZ  NOTE_E_LOW_CHZ
+#if SYMBOL_COUNT > 7
+#define NOTE_HIGHEST_CHZ NOTE_C_SHARP_HIGH_CHZ
+#else
+#define NOTE_HIGHEST_CHZ NOTE_A_CHZ
+#endif
+
 typedef enum {
     E_HIGH = 0,  // 36024  
     C_SHARP = 1, // 42840
     A = 2,       // 26984
-    E_LOW = 3    // 72056
+    E_LOW = 3,   // 72056
+    B = 4,
+    F_SHARP = 5,
+    G_SHARP = 6,
+    C_SHARP_HIGH = 7
 } Note;
 
 #endif  // NOTES_H
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef PRESS_BENCH_H
+#define PRESS_BENCH_H
+
+#include <stdint.h>
+
+/*
+ * Press latency benchmark (-DPRESS_BENCH=1): the first raw falling edge of
+ * each button press is timestamped by a pin interrupt, and the press is
+ * timed again when the debouncer accepts it. ":press" reports min, mean
+ * and max edge-to-accept latency in ms. Build with and without
+ * -DCCL_FILTER=1 to compare the two debounce paths.
+ */
+#ifndef PRESS_BENCH
+#define PRESS_BENCH 0
+#endif
+
+#if PRESS_BENCH
+
+void press_bench_init(void);
+void press_bench_accepted(uint8_t pressed);
+void press_bench_report(void);
+
+#else
+
+/* Hooks compile away completely when the mode is disabled */
+static inline void press_bench_init(void) {}
+static inline void press_bench_accepted(uint8_t pressed) { (void)pressed; }
+static inline void press_bench_report(void) {}
+
+#endif
+
+#endif // PRESS_BENCH_H
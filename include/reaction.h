@@ -0,0 +1,42 @@
+#ifndef REACTION_H
+#define REACTION_H
+
+#include <stdint.h>
+
+/*
+ * Timed game mode (-DREACTION_MODE=1). TCB1 is taken over as a free-running
+ * input capture timer, so the 5ms debounce/display tick moves into the
+ * TCB0 1ms ISR.
+ */
+#ifndef REACTION_MODE
+#define REACTION_MODE 0
+#endif
+
+#include "clock.h"
+
+// Capture timer counts CLK_PER/2 (0.6us per tick at 3.33MHz)
+#define REACTION_TICKS_PER_MS (F_CPU / 2000UL)
+
+// Reaction thresholds (ms) for speed bonus points per step
+#define REACTION_FAST_MS   300   // 3 points
+#define REACTION_MEDIUM_MS 600   // 2 points
+#define REACTION_SLOW_MS   1000  // 1 point
+
+#if REACTION_MODE
+
+void reaction_reset(void);
+void reaction_arm(void);
+void reaction_step_end(uint8_t correct);
+void reaction_round_report(void);
+
+#else
+
+/* Hooks compile away completely when the mode is disabled */
+static inline void reaction_reset(void) {}
+static inline void reaction_arm(void) {}
+static inline void reaction_step_end(uint8_t correct) { (void)correct; }
+static inline void reaction_round_report(void) {}
+
+#endif
+
+#endif // REACTION_H
@@ -0,0 +1,58 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+
+/* Build-time selection of the input record/replay mode (-DREPLAY_MODE=n) */
+#define REPLAY_OFF      0
+#define REPLAY_RECORD   1
+#define REPLAY_PLAYBACK 2
+
+#ifndef REPLAY_MODE
+#define REPLAY_MODE REPLAY_OFF
+#endif
+
+// Capacity of the record buffer in events (4 bytes each)
+#define REPLAY_BUFFER_SIZE 32
+
+// Input event kinds stored in the log
+typedef enum {
+    EVENT_END = 0,      // Terminates a replay log
+    EVENT_SYNC,         // Game entered the INPUT stage
+    EVENT_BUTTONS,      // New debounced button state (PORTA.IN image)
+    EVENT_UART,         // UART key consumed as a button (pin mask)
+    EVENT_ADC,          // New potentiometer reading used for playback delay
+    EVENT_WAIT          // Gap continues: ticks * 65536 more before the next event
+} replay_event_type;
+
+// A single logged event, timestamped in 1ms ticks since the previous event
+typedef struct {
+    uint16_t ticks;
+    uint8_t type;
+    uint8_t value;
+} replay_event;
+
+#if REPLAY_MODE == REPLAY_OFF
+
+/* Hooks compile away completely when the mode is disabled */
+static inline void replay_start(void) {}
+static inline void replay_sync(void) {}
+static inline void replay_poll(void) {}
+static inline void replay_flush(void) {}
+static inline uint8_t replay_buttons(uint8_t state) { return state; }
+static inline uint8_t replay_key(uint8_t key) { return key; }
+static inline uint8_t replay_adc(uint8_t value) { return value; }
+
+#else
+
+void replay_start(void);
+void replay_sync(void);
+void replay_poll(void);
+void replay_flush(void);
+uint8_t replay_buttons(uint8_t state);
+uint8_t replay_key(uint8_t key);
+uint8_t replay_adc(uint8_t value);
+
+#endif
+
+#endif // REPLAY_H
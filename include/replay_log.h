@@ -0,0 +1,23 @@
+// replay_log.h - Captured session replayed when built with REPLAY_MODE=REPLAY_PLAYBACK
+#ifndef REPLAY_LOG_H
+#define REPLAY_LOG_H
+
+/*
+ * Paste a recorded session here. Each "#E" line streamed in record mode
+ * becomes one { ticks, type, value } entry, and the "#S" line gives the seed:
+ *
+ *   #S11638494      -> #define REPLAY_LOG_SEED 0x11638494
+ *   #E01F40310      -> { 0x01F4, 0x03, 0x10 },
+ *   #E00020500      -> { 0x0002, 0x05, 0x00 },   (EVENT_WAIT)
+ *
+ * The log must end with an EVENT_END entry. scripts/replay_run.py runs a
+ * capture (or this log) through the input path on the host.
+ */
+#define REPLAY_LOG_SEED 0x11638494
+
+#define REPLAY_LOG_EVENTS \
+    {                     \
+        { 0, EVENT_END, 0 } \
+    }
+
+#endif // REPLAY_LOG_H
@@ -0,0 +1,23 @@
+#ifndef SCORE_H
+#define SCORE_H
+
+#include <stdint.h>
+
+// Number of decimal digits held by a counter (must be even)
+#define SCORE_DIGITS 6
+
+// Packed BCD counter, least significant digit pair first
+typedef struct {
+    uint8_t bcd[SCORE_DIGITS / 2];
+} bcd_counter_t;
+
+extern bcd_counter_t score;   // Points: completed rounds plus any bonus
+extern bcd_counter_t level;   // Current sequence length
+
+void score_reset(void);
+void score_level_up(void);
+void bcd_add(bcd_counter_t *counter, uint8_t amount);
+uint8_t bcd_digit(const bcd_counter_t *counter, uint8_t index);
+void bcd_display_digits(const bcd_counter_t *counter, uint8_t *left_digit, uint8_t *right_digit);
+
+#endif // SCORE_H
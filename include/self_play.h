@@ -0,0 +1,63 @@
+#ifndef SELF_PLAY_H
+#define SELF_PLAY_H
+
+#include <stdint.h>
+#include "replay.h"
+
+/*
+ * Self-play soak test (-DSELF_PLAY=1): a bot follows the generator with
+ * its own copy of the round's start state and presses the expected
+ * symbols through the UART key path, SELF_PLAY_REACTION_MS (+-25%) after
+ * each press completes. SELF_PLAY_ERROR_PERMILLE of presses are made
+ * wrong on purpose. The playback delay is fixed at its minimum. ":bot"
+ * reports rounds, throughput, timing violations and anomalies:
+ * - Timing: playback not taking steps x delay (within 2ms per step), or
+ *   an injected press not picked up within SELF_PLAY_PICKUP_MS
+ * - Anomaly: a FAIL without a wrong press, a SUCCESS after one or before
+ *   the round's presses ran out, or an unknown stage
+ */
+#ifndef SELF_PLAY
+#define SELF_PLAY 0
+#endif
+
+#ifndef SELF_PLAY_REACTION_MS
+#define SELF_PLAY_REACTION_MS 200
+#endif
+
+#ifndef SELF_PLAY_ERROR_PERMILLE
+#define SELF_PLAY_ERROR_PERMILLE 0
+#endif
+
+#define SELF_PLAY_PICKUP_MS 10
+#define SELF_PLAY_SLACK_MS 2
+
+#if SELF_PLAY && REPLAY_MODE == REPLAY_PLAYBACK
+#error "SELF_PLAY needs live input; it cannot run with replay playback"
+#endif
+
+#if SELF_PLAY
+
+void self_play_init(void);
+uint8_t self_play_start_keys(void);
+void self_play_playback(uint16_t steps);
+void self_play_round_start(void);
+void self_play_poll(void);
+void self_play_round_end(uint8_t success);
+void self_play_anomaly(void);
+void self_play_report(void);
+
+#else
+
+/* Hooks compile away completely when the mode is disabled */
+static inline void self_play_init(void) {}
+static inline uint8_t self_play_start_keys(void) { return 0; }
+static inline void self_play_playback(uint16_t steps) { (void)steps; }
+static inline void self_play_round_start(void) {}
+static inline void self_play_poll(void) {}
+static inline void self_play_round_end(uint8_t success) { (void)success; }
+static inline void self_play_anomaly(void) {}
+static inline void self_play_report(void) {}
+
+#endif
+
+#endif // SELF_PLAY_H
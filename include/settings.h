@@ -0,0 +1,41 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stdint.h>
+
+/*
+ * Persistent settings block, kept in USERROW (which also survives a chip
+ * erase). Loaded once at boot; changes are written back after
+ * SETTINGS_WRITE_DELAY_MS without further changes, so a burst of
+ * adjustments costs one NVM write, and only bytes that differ are
+ * reprogrammed.
+ *
+ * Bump SETTINGS_VERSION whenever the layout changes; a block with another
+ * version or a bad CRC is ignored and the compiled defaults are used.
+ * Version 2 marks the typeahead window unset instead of storing 0 from
+ * builds without typeahead.
+ */
+#define SETTINGS_VERSION 2
+#define SETTINGS_WRITE_DELAY_MS 2000
+
+// Stored typeahead window meaning "use the compiled TYPEAHEAD_MS"
+#define SETTINGS_EARLY_UNSET 0xFFFF
+
+typedef struct __attribute__((packed)) {
+    uint8_t version;     // SETTINGS_VERSION
+    int8_t octave;       // frequency, min_frequency to max_frequency
+    uint8_t brightness;  // display_brightness, 0 to DISPLAY_BRIGHTNESS_MAX
+    uint16_t delay;      // playback_delay_override, 0 follows the pot
+    uint16_t early;      // typeahead_window in ms, or SETTINGS_EARLY_UNSET
+    uint32_t seed;       // Seed last set from the console
+    uint16_t crc;        // CRC-16/XMODEM of the bytes above
+} settings_t;
+
+// SRAM copy of the stored block
+extern settings_t settings;
+
+void settings_load(void);
+void settings_touch(void);
+void settings_poll(void);
+
+#endif // SETTINGS_H
@@ -1,5 +1,32 @@
+#ifndef SPI_H
+#define SPI_H
 
 #include <avr/io.h>
-#include <avr/interrupt.h>
+#include "display.h"
+#include "flags.h"
 
-void spi_write(void);
\ No newline at end of file
+/**
+ * Writes the next digit of the multiplexed display to the SPI bus
+ *
+ * Inlined into the timer ISRs so they make no calls and only save the
+ * registers they use. The side being driven is a GPIOR0 bit: tested with
+ * SBIS and toggled with SBI/CBI, no RAM access or reserved register.
+ * The SPI ISR latches the byte when the transfer completes.
+ * 
+ * A committed back frame becomes the front one only at the frame
+ * boundary, before the left digit, so digits never mix across frames.
+ */
+static inline void spi_write(void) {
+    if (flag_test(FLAG_DISPLAY_SIDE)) {
+        SPI0.DATA = display_frames[flag_test(FLAG_DISPLAY_FRONT) ? 1 : 0].right;
+        flag_clear(FLAG_DISPLAY_SIDE);
+    } else {
+        if (flag_test(FLAG_DISPLAY_COMMIT)) {
+            GPIOR0 ^= (1 << FLAG_DISPLAY_FRONT) | (1 << FLAG_DISPLAY_COMMIT);  // Flip, consume
+        }
+        SPI0.DATA = display_frames[flag_test(FLAG_DISPLAY_FRONT) ? 1 : 0].left;
+        flag_set(FLAG_DISPLAY_SIDE);
+    }
+}
+
+#endif // SPI_H
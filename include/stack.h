@@ -0,0 +1,17 @@
+#ifndef STACK_H
+#define STACK_H
+
+#include <stdint.h>
+
+// Byte pattern written over free SRAM at startup
+#define STACK_CANARY 0xC5
+
+// Set by the UART receive handler to request a memory report
+extern volatile uint8_t stack_report_requested;
+
+uint16_t stack_unused(void);
+uint16_t stack_peak(void);
+uint16_t static_ram_used(void);
+void stack_report(void);
+
+#endif // STACK_H
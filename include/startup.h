@@ -0,0 +1,48 @@
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include <stdint.h>
+
+/*
+ * Start-up instrumentation (-DSTARTUP_TRACE=1): each init stage and the
+ * first audible note are timestamped from TCB0, which timers_init()
+ * starts first, and the times are reported over UART after the first
+ * playback. The fuse start-up delay (FUSE.SYSCFG1 SUT) that runs before
+ * the CPU leaves reset is added from the fuse setting; C start-up code
+ * before main() is not measured.
+ */
+#ifndef STARTUP_TRACE
+#define STARTUP_TRACE 0
+#endif
+
+typedef enum {
+    STARTUP_CLOCK,
+    STARTUP_TIMERS,       // Time zero
+    STARTUP_ADC,
+    STARTUP_BUTTONS,
+    STARTUP_IRQ,
+    STARTUP_SPI,
+    STARTUP_PWM,
+    STARTUP_UART,
+    STARTUP_SETTINGS,
+    STARTUP_MAIN_LOOP,    // Interrupts enabled
+    STARTUP_FIRST_TONE,
+    STARTUP_STAGE_COUNT
+} startup_stage_t;
+
+#if STARTUP_TRACE
+
+void startup_stamp(startup_stage_t stage);
+void startup_first_tone(void);
+void startup_report(void);
+
+#else
+
+/* Hooks compile away completely when the mode is disabled */
+static inline void startup_stamp(startup_stage_t stage) { (void)stage; }
+static inline void startup_first_tone(void) {}
+static inline void startup_report(void) {}
+
+#endif
+
+#endif // STARTUP_H
@@ -16,11 +16,11 @@ typedef enum {
     S1,
     S2,
     S3,
-    S4
+    S4,
+    S5,     // S5-S8 exist with SYMBOL_COUNT > 4 (symbols.h)
+    S6,
+    S7,
+    S8
 } buttons;
 
-// Declare external variables for button and gameplay stage
-extern buttons button;
-extern simon_stage stage;
-
 #endif // STATES_M_H
@@ -0,0 +1,55 @@
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include <avr/io.h>
+
+/*
+ * Symbol alphabet (-DSYMBOL_COUNT=n, 2 to 8, default 4).
+ *
+ * Symbols S1-S4 are the buttons on PA4-PA7; S5-S8 take the PORTA bits
+ * PA0-PA3. Those are not free on the QUTy: PA0 is UPDI, PA1 drives the
+ * display latch, PA2 is the potentiometer and PA3 carries voice 1 in
+ * DUAL_VOICE builds. S5-S8 are therefore played from the UART keymap;
+ * PA0 (with UPDI disabled) or PA3 (single voice) may be wired to a button
+ * and listed in SYMBOL_BUTTON_MASK. Tone and display tables are sized
+ * from SYMBOL_COUNT, and the default build compiles to the same code as
+ * the fixed four-symbol game.
+ */
+#ifndef SYMBOL_COUNT
+#define SYMBOL_COUNT 4
+#endif
+
+#if SYMBOL_COUNT < 2 || SYMBOL_COUNT > 8
+#error "SYMBOL_COUNT must be 2 to 8"
+#endif
+
+// Generator bits drawn per step; counts that are not a power of two
+// reject out-of-range draws rather than folding them (no modulo bias)
+#if SYMBOL_COUNT > 4
+#define SYMBOL_BITS 3
+#elif SYMBOL_COUNT > 2
+#define SYMBOL_BITS 2
+#else
+#define SYMBOL_BITS 1
+#endif
+#define SYMBOL_BITS_MASK ((1u << SYMBOL_BITS) - 1)
+
+// PORTA pin number and mask for a symbol: 0-3 -> PA4-PA7, 4-7 -> PA0-PA3
+#define SYMBOL_PIN_NUMBER(symbol) (((symbol) + 4) & 7)
+#define SYMBOL_PIN(symbol) (1 << SYMBOL_PIN_NUMBER(symbol))
+
+// Symbols with a physical button (debounced); the rest are UART-only
+#ifndef SYMBOL_BUTTON_MASK
+#if SYMBOL_COUNT >= 4
+#define SYMBOL_BUTTON_MASK (PIN4_bm | PIN5_bm | PIN6_bm | PIN7_bm)
+#else
+#define SYMBOL_BUTTON_MASK (((1 << SYMBOL_COUNT) - 1) << 4)
+#endif
+#endif
+
+// PA1 and PA2 are outputs and analog input; PA3 is checked in buzzer.h
+#if (SYMBOL_BUTTON_MASK) & 0x06
+#error "SYMBOL_BUTTON_MASK must not contain PA1 (display latch) or PA2 (potentiometer)"
+#endif
+
+#endif // SYMBOLS_H
@@ -0,0 +1,70 @@
+#ifndef TEMPO_H
+#define TEMPO_H
+
+#include <stdint.h>
+#include "input.h"
+
+/*
+ * Tempo curves (-DTEMPO_CURVE=n): the pot (or console) delay is the base
+ * tempo and is scaled down as the sequence grows, so later rounds are
+ * faster as well as longer.
+ *
+ *   0  Flat: the delay depends on the pot only (default)
+ *   1  Linear: TEMPO_LINEAR_STEP/256 of the base faster per level
+ *   2  Exponential: twice as fast every TEMPO_HALF_LEVELS levels
+ *   3  Stepped: 1/8 of the base faster every TEMPO_STEP_LEVELS levels
+ *
+ * Scale factors for levels 1 to TEMPO_LEVELS are computed by the compiler
+ * into a flash table; later levels keep the last factor. Every curve is
+ * limited to TEMPO_FLOOR_Q8/256 of the base, and the gap between notes
+ * never drops below TEMPO_MIN_GAP_MS.
+ */
+#ifndef TEMPO_CURVE
+#define TEMPO_CURVE 0
+#endif
+
+#define TEMPO_FLAT        0
+#define TEMPO_LINEAR      1
+#define TEMPO_EXPONENTIAL 2
+#define TEMPO_STEPPED     3
+
+#define TEMPO_LEVELS 32
+
+#ifndef TEMPO_FLOOR_Q8
+#define TEMPO_FLOOR_Q8 96           // Never faster than 37.5% of the base
+#endif
+#ifndef TEMPO_LINEAR_STEP
+#define TEMPO_LINEAR_STEP 8         // ~3% per level
+#endif
+#ifndef TEMPO_HALF_LEVELS
+#define TEMPO_HALF_LEVELS 16
+#endif
+#ifndef TEMPO_STEP_LEVELS
+#define TEMPO_STEP_LEVELS 5
+#endif
+
+/*
+ * Shortest gap (half the delay): a press is held for the gap, so it must
+ * leave time for the debouncer to accept the press and then the release,
+ * or quick players lose presses. Defaults to the worst-case accept
+ * latencies in input.h; set it from ":press" measurements if needed.
+ */
+#ifndef TEMPO_MIN_GAP_MS
+#define TEMPO_MIN_GAP_MS (PRESS_ACCEPT_MAX_MS + RELEASE_ACCEPT_MAX_MS)
+#endif
+
+#if TEMPO_CURVE
+
+uint16_t tempo_scale(uint16_t delay, uint16_t sequence_length);
+
+#else
+
+/* Hooks compile away completely when the mode is disabled */
+static inline uint16_t tempo_scale(uint16_t delay, uint16_t sequence_length) {
+    (void)sequence_length;
+    return delay;
+}
+
+#endif
+
+#endif // TEMPO_H
@@ -1,8 +1,29 @@
+#ifndef TIMER_H
+#define TIMER_H
+
 #include <stdint.h>
 
-volatile uint16_t playback_delay;
-volatile uint16_t playback_timer;
+extern volatile uint16_t playback_delay;
+extern uint16_t playback_delay_override;
+
+// Shortest delay the pot selects (ADC 0 in calculate_playback_delay())
+#define PLAYBACK_DELAY_MIN (2000 >> 3)
+
+// Monotonic 1ms tick count; wraps after ~49 days
+uint32_t ticks_now(void);
+
+// Ticks elapsed since an earlier ticks_now() value, wrap-safe
+static inline uint32_t ticks_since(uint32_t start) {
+    return ticks_now() - start;
+}
+
+// Non-zero once a deadline from ticks_now() + n has passed, wrap-safe
+static inline uint8_t deadline_reached(uint32_t deadline) {
+    return (int32_t)(ticks_now() - deadline) >= 0;
+}
+
 void calculate_playback_delay(void);
 void delay(void);
 void half_of_delay(void);
-uint8_t adc_ready_flag;
\ No newline at end of file
+
+#endif // TIMER_H
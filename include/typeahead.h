@@ -0,0 +1,40 @@
+#ifndef TYPEAHEAD_H
+#define TYPEAHEAD_H
+
+#include <stdint.h>
+
+/*
+ * Typeahead (-DTYPEAHEAD_MS=n): presses made during playback or the SUCCESS
+ * pattern are queued with timestamps and checked in order once INPUT
+ * begins. Only presses in the early-input window, the last n ms before
+ * INPUT, count; older ones are dropped. 0 disables the mode.
+ */
+#ifndef TYPEAHEAD_MS
+#define TYPEAHEAD_MS 0
+#endif
+
+// Queued presses (power of two); the oldest is dropped when full
+#define TYPEAHEAD_SIZE 8
+
+#if TYPEAHEAD_MS
+
+extern uint16_t typeahead_window;
+
+uint8_t typeahead_accepting(void);
+void typeahead_poll(void);
+void typeahead_begin(void);
+uint8_t typeahead_next(uint8_t *pressed);
+void typeahead_clear(void);
+
+#else
+
+/* Hooks compile away completely when the mode is disabled */
+static inline uint8_t typeahead_accepting(void) { return 0; }
+static inline void typeahead_poll(void) {}
+static inline void typeahead_begin(void) {}
+static inline uint8_t typeahead_next(uint8_t *pressed) { (void)pressed; return 0; }
+static inline void typeahead_clear(void) {}
+
+#endif
+
+#endif // TYPEAHEAD_H
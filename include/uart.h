@@ -1,7 +1,17 @@
+#ifndef UART_H
+#define UART_H
+
 #include <stdint.h>
+#include "score.h"
+
+// Transmit queue capacity in bytes (power of two)
+#define UART_TX_SIZE 64
 
-volatile uint8_t button_active;
 void uart_putc(uint8_t);
+uint8_t uart_tx_free(void);
+uint8_t uart_tx_idle(void);
+void uart_flush(void);
 void uart_puts(char *string);
-void send_score(uint16_t score);
+void send_score(const bcd_counter_t *counter);
 
+#endif // UART_H
@@ -0,0 +1,21 @@
+#ifndef UART_FORMAT_H
+#define UART_FORMAT_H
+
+#include <avr/pgmspace.h>
+
+/*
+ * Formatted UART output with format strings kept in flash.
+ *
+ * uart_printf("score %u\n", n) places the literal in flash via PSTR(), so
+ * adding messages costs no SRAM. Supported conversions:
+ *   %d %i %u %x %X %c %s (RAM string) %S (flash string) %%
+ * with an optional '0' flag, field width and 'l' length modifier,
+ * e.g. "%05u" or "%08lX". Left alignment is not supported.
+ */
+#define uart_printf(format, ...) uart_printf_P(PSTR(format), ##__VA_ARGS__)
+#define uart_puts_F(string) uart_puts_P(PSTR(string))
+
+void uart_printf_P(const char *format, ...);
+void uart_puts_P(const char *string);
+
+#endif // UART_FORMAT_H
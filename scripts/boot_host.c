@@ -0,0 +1,150 @@
+/**
+ * @file boot_host.c
+ * @brief Host harness running src/boot/bootloader.c over stdin/stdout
+ *
+ * Built by scripts/boot_upload.py --simulate with a copy of the bootloader
+ * source in which main() is renamed bootloader_main() and the jump to the
+ * application calls host_start_app(); nothing else is changed. Starts as
+ * after the application's :boot reset, with erased flash.
+ *
+ * Once stdin closes, no byte is ever received again and the bootloader
+ * sees its receive timeouts expire. Exit status: 3 when the application
+ * is started, 0 if it is still waiting after a few entry timeouts.
+ * The committed flash is written to the file given as the argument.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <poll.h>
+#include "boot_host.h"
+
+uint8_t host_flash[PROGMEM_SIZE];          // Flash as the bootloader sees it
+static uint8_t committed[PROGMEM_SIZE];    // Flash as programmed
+
+host_usart_t USART0;
+host_nvmctrl_t NVMCTRL;
+host_rstctrl_t RSTCTRL;
+host_clkctrl_t CLKCTRL;
+host_port_t PORTB;
+
+static const char *dump_path;
+static uint8_t rx_byte;
+static uint8_t rx_pending;
+static uint8_t tx_pending;
+static uint8_t rx_closed;
+static uint32_t empty_polls;               // Status reads without input
+static uint32_t idle_polls;                // Status reads since stdin closed
+
+// Status reads without input before each read waits up to 1ms, so
+// transmit status checks stay instant and receive waits do not spin
+#define SPIN_POLLS 1000
+
+// Status reads after stdin closed before giving up (several entry timeouts)
+#define IDLE_POLL_LIMIT (1ul << 26)
+
+int bootloader_main(void);
+
+/**
+ * Sends the byte last stored in TXDATAL, if any
+ */
+static void tx_flush(void) {
+    if (tx_pending) {
+        tx_pending = 0;
+        if (write(STDOUT_FILENO, USART0.TXDATAL_, 1) != 1) {
+            exit(1);
+        }
+    }
+}
+
+/**
+ * Ends the run, saving the programmed flash
+ */
+static void host_exit(int status) {
+    tx_flush();
+    if (dump_path) {
+        FILE *f = fopen(dump_path, "wb");
+        if (!f || fwrite(committed, 1, sizeof committed, f) != sizeof committed) {
+            exit(1);
+        }
+        fclose(f);
+    }
+    exit(status);
+}
+
+/**
+ * Refreshes the status registers, waiting for the next input byte
+ */
+uint8_t host_status(void) {
+    tx_flush();
+    if (!rx_pending && !rx_closed) {
+        struct pollfd input = { .fd = STDIN_FILENO, .events = POLLIN };
+        if (poll(&input, 1, empty_polls > SPIN_POLLS) > 0) {
+            if (read(STDIN_FILENO, &rx_byte, 1) == 1) {
+                rx_pending = 1;
+                empty_polls = 0;
+            } else {
+                rx_closed = 1;  // Host closed the link
+            }
+        } else {
+            empty_polls++;
+        }
+    }
+    if (rx_closed && ++idle_polls > IDLE_POLL_LIMIT) {
+        host_exit(0);
+    }
+    USART0.STATUS_[0] = (rx_pending ? USART_RXCIF_bm : 0) | USART_TXCIF_bm | USART_DREIF_bm;
+    NVMCTRL.STATUS_[0] = 0;
+    return 0;
+}
+
+/**
+ * Moves the next input byte into RXDATAL
+ */
+uint8_t host_rx(void) {
+    if (!rx_pending) {
+        host_status();
+    }
+    USART0.RXDATAL_[0] = rx_byte;
+    rx_pending = 0;
+    return 0;
+}
+
+/**
+ * Makes room in TXDATAL for the byte about to be stored
+ */
+uint8_t host_tx(void) {
+    tx_flush();
+    tx_pending = 1;
+    return 0;
+}
+
+/**
+ * Executes an NVM command on the page buffer
+ *
+ * Page buffer writes go straight into host_flash, so PAGEERASEWRITE keeps
+ * every changed page and PAGEBUFCLR undoes the writes.
+ */
+void host_nvm(uint8_t command) {
+    if (command == NVMCTRL_CMD_PAGEERASEWRITE_gc) {
+        memcpy(committed, host_flash, sizeof committed);
+    } else if (command == NVMCTRL_CMD_PAGEBUFCLR_gc) {
+        memcpy(host_flash, committed, sizeof committed);
+    }
+}
+
+/**
+ * Stands in for the jump to the application's reset vector
+ */
+void host_start_app(void) {
+    host_exit(3);
+}
+
+int main(int argc, char **argv) {
+    dump_path = argc > 1 ? argv[1] : NULL;
+    memset(host_flash, 0xFF, sizeof host_flash);
+    memset(committed, 0xFF, sizeof committed);
+    RSTCTRL.RSTFR = RSTCTRL_SWRF_bm;  // Reset requested by :boot
+    return bootloader_main();
+}
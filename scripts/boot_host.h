@@ -0,0 +1,81 @@
+#ifndef BOOT_HOST_H
+#define BOOT_HOST_H
+
+/*
+ * Host stand-ins for the avr-libc names src/boot/bootloader.c uses, so
+ * scripts/boot_upload.py --simulate can run the real frame handling.
+ *
+ * USART0 bytes are stdin/stdout. Register fields that move data are
+ * arrays indexed by a host call, so reading RXDATAL takes the next input
+ * byte, writing TXDATAL queues an output byte and reading STATUS waits
+ * for input (stdin closed ends the run). Flash is an array; writes
+ * through the mapped window land in it directly and the page buffer
+ * commands commit or discard them (boot_host.c).
+ */
+
+#include <stdint.h>
+
+#define PROGMEM_SIZE 16384
+#define PROGMEM_PAGE_SIZE 64
+
+extern uint8_t host_flash[PROGMEM_SIZE];
+#define MAPPED_PROGMEM_START ((uintptr_t)host_flash)
+
+uint8_t host_status(void);
+uint8_t host_rx(void);
+uint8_t host_tx(void);
+void host_nvm(uint8_t command);
+void host_start_app(void);
+
+#define STATUS STATUS_[host_status()]
+#define RXDATAL RXDATAL_[host_rx()]
+#define TXDATAL TXDATAL_[host_tx()]
+
+typedef struct {
+    uint8_t STATUS_[1];
+    uint8_t RXDATAL_[1];
+    uint8_t TXDATAL_[1];
+    uint8_t CTRLB;
+    uint16_t BAUD;
+} host_usart_t;
+
+typedef struct {
+    uint8_t CTRLA;
+    uint8_t STATUS_[1];
+} host_nvmctrl_t;
+
+typedef struct { uint8_t RSTFR; } host_rstctrl_t;
+typedef struct { uint8_t MCLKCTRLB; } host_clkctrl_t;
+typedef struct { uint8_t DIRSET, DIRCLR; } host_port_t;
+
+extern host_usart_t USART0;
+extern host_nvmctrl_t NVMCTRL;
+extern host_rstctrl_t RSTCTRL;
+extern host_clkctrl_t CLKCTRL;
+extern host_port_t PORTB;
+
+#define USART_RXCIF_bm 0x80
+#define USART_TXCIF_bm 0x40
+#define USART_DREIF_bm 0x20
+#define USART_RXEN_bm 0x80
+#define USART_TXEN_bm 0x40
+#define NVMCTRL_CMD_PAGEERASEWRITE_gc 0x03
+#define NVMCTRL_CMD_PAGEBUFCLR_gc 0x04
+#define NVMCTRL_FBUSY_bm 0x01
+#define RSTCTRL_SWRF_bm 0x10
+#define CLKCTRL_PDIV_6X_gc 0x10
+#define CLKCTRL_PEN_bm 0x01
+#define PIN2_bm 0x04
+
+#define _PROTECTED_WRITE(reg, value) ((reg) = (value))
+#define _PROTECTED_WRITE_SPM(reg, value) host_nvm(value)
+
+static inline uint16_t _crc_xmodem_update(uint16_t crc, uint8_t data) {
+    crc ^= (uint16_t)data << 8;
+    for (uint8_t i = 0; i < 8; i++) {
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+#endif // BOOT_HOST_H
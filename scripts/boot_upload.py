@@ -0,0 +1,272 @@
+#!/usr/bin/env python3
+"""
+Host uploader for the serial bootloader (src/boot/bootloader.c).
+
+    python3 scripts/boot_upload.py /dev/ttyACM0 .pio/build/QUTy_boot/firmware.hex
+    python3 scripts/boot_upload.py --simulate firmware.hex
+
+Sends ":boot" to the running game at its console baud, switches to the
+bootloader baud, then writes the image a page at a time (each page frame
+is acknowledged after it is programmed), verifies the whole image by CRC
+and starts it. A unit that has no application, or is already in the
+bootloader, is picked up by the identify retries.
+
+--simulate builds src/boot/bootloader.c for the host with
+scripts/boot_host.c and uploads into it instead of a port, so images, the
+framing and the bootloader's own frame handling are checked without
+hardware; the programmed flash is compared with the image afterwards.
+Only the receive timeouts and the flash controller itself are not
+exercised. Only the standard library and a host C compiler are used
+(termios, no pyserial). Protocol constants match include/boot.h.
+"""
+
+import argparse
+import os
+import select
+import shutil
+import subprocess
+import sys
+import tempfile
+import termios
+import time
+import tty
+
+CMD_IDENTIFY, CMD_PAGE, CMD_VERIFY, CMD_GO = b"I", b"P", b"V", b"G"
+ACK, NAK = b"K", b"N"
+FLASH_SIZE = 16384
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+# Lines of bootloader.c replaced for the host build (scripts/boot_host.c)
+HOST_EDITS = {"((void (*)(void))(BOOT_SIZE / 2))();": "host_start_app();",
+              "int main(void) {": "int bootloader_main(void) {"}
+
+BAUD = {9600: termios.B9600, 19200: termios.B19200, 38400: termios.B38400,
+        57600: termios.B57600, 115200: termios.B115200, 230400: termios.B230400}
+
+
+def crc16_xmodem(data, crc=0):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+        crc &= 0xFFFF
+    return crc
+
+
+def frame(command, payload=b""):
+    body = command + payload
+    return body + crc16_xmodem(body).to_bytes(2, "big")
+
+
+def load_image(path):
+    """Returns {address: byte} from an Intel HEX or raw binary file."""
+    memory = {}
+    if not path.endswith(".hex"):
+        with open(path, "rb") as f:
+            return dict(enumerate(f.read()))
+    base = 0
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith(":"):
+                continue
+            record = bytes.fromhex(line[1:])
+            if sum(record) & 0xFF:
+                raise ValueError("bad checksum: " + line)
+            length, address, kind = record[0], int.from_bytes(record[1:3], "big"), record[3]
+            data = record[4:4 + length]
+            if kind == 0:
+                for i, byte in enumerate(data):
+                    memory[base + address + i] = byte
+            elif kind == 2:
+                base = int.from_bytes(data, "big") << 4
+            elif kind == 4:
+                base = int.from_bytes(data, "big") << 16
+    return memory
+
+
+class Port:
+    """Raw serial port with timeouts."""
+
+    def __init__(self, path, baud):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.fd)
+        self.set_baud(baud)
+
+    def set_baud(self, baud):
+        termios.tcdrain(self.fd)
+        attrs = termios.tcgetattr(self.fd)
+        attrs[4] = attrs[5] = BAUD[baud]
+        termios.tcsetattr(self.fd, termios.TCSANOW, attrs)
+
+    def flush(self):
+        termios.tcflush(self.fd, termios.TCIFLUSH)
+
+    def write(self, data):
+        os.write(self.fd, data)
+
+    def read(self, count, timeout):
+        data = b""
+        deadline = time.monotonic() + timeout
+        while len(data) < count:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0 or not select.select([self.fd], [], [], remaining)[0]:
+                break
+            data += os.read(self.fd, count - len(data))
+        return data
+
+
+class SimulatedBootloader:
+    """src/boot/bootloader.c built for the host, driven over pipes."""
+
+    def __init__(self, boot_size, cc):
+        self.build = tempfile.mkdtemp(prefix="boot_host")
+        with open(os.path.join(ROOT, "src", "boot", "bootloader.c")) as f:
+            source = f.read()
+        for line, replacement in HOST_EDITS.items():
+            if line not in source:
+                sys.exit("simulate: %r not found in bootloader.c" % line)
+            source = source.replace(line, replacement)
+        with open(os.path.join(self.build, "bootloader.c"), "w") as f:
+            f.write(source)
+        for header in ("avr/io.h", "avr/cpufunc.h", "util/crc16.h"):
+            os.makedirs(os.path.join(self.build, os.path.dirname(header)), exist_ok=True)
+            with open(os.path.join(self.build, header), "w") as f:
+                f.write('#include "boot_host.h"\n')
+
+        binary = os.path.join(self.build, "bootloader")
+        subprocess.run([cc, "-std=gnu99", "-Wall", "-DBOOT_SIZE=%d" % boot_size,
+                        "-I", self.build,
+                        "-I", os.path.join(ROOT, "include"), "-I", os.path.join(ROOT, "scripts"),
+                        os.path.join(self.build, "bootloader.c"),
+                        os.path.join(ROOT, "scripts", "boot_host.c"), "-o", binary], check=True)
+        self.flash_path = os.path.join(self.build, "flash.bin")
+        self.process = subprocess.Popen([binary, self.flash_path], stdin=subprocess.PIPE,
+                                        stdout=subprocess.PIPE, bufsize=0)
+
+    def set_baud(self, baud):
+        pass
+
+    def flush(self):
+        while select.select([self.process.stdout], [], [], 0)[0]:
+            if not os.read(self.process.stdout.fileno(), 256):
+                break
+
+    def write(self, data):
+        if data.startswith(b":boot"):
+            return  # For the game, which has already reset into the bootloader
+        self.process.stdin.write(data)
+
+    def read(self, count, timeout):
+        data = b""
+        deadline = time.monotonic() + timeout
+        while len(data) < count:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0 or not select.select([self.process.stdout], [], [], remaining)[0]:
+                break
+            chunk = os.read(self.process.stdout.fileno(), count - len(data))
+            if not chunk:
+                break
+            data += chunk
+        return data
+
+    def finish(self):
+        """Returns (started, flash) once the bootloader has exited."""
+        self.process.stdin.close()
+        status = self.process.wait(timeout=5)
+        with open(self.flash_path, "rb") as f:
+            flash = f.read()
+        shutil.rmtree(self.build)
+        return status == 3, flash
+
+
+def transact(port, data, reply_length=1, retries=3, timeout=0.5):
+    for _ in range(retries):
+        port.flush()
+        port.write(data)
+        reply = port.read(reply_length, timeout)
+        if reply[:1] == ACK and len(reply) == reply_length:
+            return reply
+    return None
+
+
+def upload(port, memory, args):
+    # Ask the game to reset into the bootloader, then talk at the boot baud
+    port.write(b":boot\n")
+    time.sleep(0.2)
+    port.set_baud(args.baud)
+
+    info = None
+    deadline = time.monotonic() + args.wait
+    while info is None and time.monotonic() < deadline:
+        info = transact(port, frame(CMD_IDENTIFY), reply_length=3, retries=1, timeout=0.2)
+    if info is None:
+        sys.exit("no reply from the bootloader")
+    page_size, boot_size = info[1], info[2] * 256
+    print("bootloader: %d byte pages, %d bytes reserved" % (page_size, boot_size))
+
+    low, high = min(memory), max(memory) + 1
+    if low != boot_size:
+        sys.exit("image starts at 0x%04X; link the application at 0x%04X "
+                 "(env:QUTy_boot)" % (low, boot_size))
+    if high > FLASH_SIZE:
+        sys.exit("image does not fit in flash")
+
+    # Pages are written contiguously from boot_size, so the verify CRC can
+    # cover the whole range with erased gaps as 0xFF
+    end = (high + page_size - 1) // page_size * page_size
+    image = bytes(memory.get(a, 0xFF) for a in range(boot_size, end))
+
+    start = time.monotonic()
+    for offset in range(0, len(image), page_size):
+        address = boot_size + offset
+        payload = address.to_bytes(2, "little") + image[offset:offset + page_size]
+        if transact(port, frame(CMD_PAGE, payload)) is None:
+            sys.exit("page 0x%04X failed" % address)
+        print("\rwritten %5d/%d bytes" % (offset + page_size, len(image)), end="", flush=True)
+    elapsed = time.monotonic() - start
+    print("\n%d bytes in %.2fs (%.0f bytes/s)" % (len(image), elapsed, len(image) / elapsed))
+
+    verify = len(image).to_bytes(2, "little") + crc16_xmodem(image).to_bytes(2, "little")
+    if transact(port, frame(CMD_VERIFY, verify), timeout=2.0) is None:
+        sys.exit("verify failed")
+    if transact(port, frame(CMD_GO)) is None:
+        sys.exit("application did not start")
+    print("verified, application started")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("port", nargs="?", help="serial device of the unit")
+    parser.add_argument("image", help="firmware.hex (or raw .bin linked at BOOT_SIZE)")
+    parser.add_argument("--baud", type=int, default=115200, choices=sorted(BAUD),
+                        help="bootloader rate (BOOT_BAUD)")
+    parser.add_argument("--app-baud", type=int, default=9600, choices=sorted(BAUD),
+                        help="console rate of the running game (UART_BAUD)")
+    parser.add_argument("--wait", type=float, default=5.0, help="seconds to wait for the bootloader")
+    parser.add_argument("--simulate", action="store_true",
+                        help="upload into bootloader.c built for the host")
+    parser.add_argument("--boot-size", type=int, default=1024, help="BOOT_SIZE for --simulate")
+    parser.add_argument("--cc", default=os.environ.get("CC", "cc"), help="host C compiler for --simulate")
+    args = parser.parse_args()
+
+    memory = load_image(args.image)
+    if args.simulate:
+        port = SimulatedBootloader(args.boot_size, args.cc)
+        if min(memory) == 0 and not args.image.endswith(".hex"):
+            memory = {a + args.boot_size: b for a, b in memory.items()}
+        upload(port, memory, args)
+        started, flash = port.finish()
+        wrong = [a for a, b in memory.items() if flash[a] != b]
+        if wrong or flash[:args.boot_size] != b"\xFF" * args.boot_size or not started:
+            sys.exit("simulated: flash differs from the image at %d addresses%s" % (
+                len(wrong), "" if started else ", application not started"))
+        print("simulated: flash matches the image, application started")
+    else:
+        if not args.port:
+            parser.error("give a serial port or --simulate")
+        upload(Port(args.port, args.app_baud), memory, args)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+"""
+Runs the ':gen' sequence generator benchmark on the host.
+
+    python3 scripts/generator_bench.py [--seed 11638494] [--symbols 2 4 8]
+
+Compiles src/lsfr.c, src/generator_bench.c and src/uart_format.c with
+scripts/generator_bench_host.c for each symbol count and prints the same
+lines the console command prints on the target (chi-square, pair
+chi-square, runs). The seed defaults to the one the game starts with.
+Cycle counts need the target: run ':gen' on the board for those.
+
+Only the few avr-libc names these files use are stubbed, in a temporary
+directory.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCES = ["src/lsfr.c", "src/generator_bench.c", "src/uart_format.c",
+           "scripts/generator_bench_host.c"]
+
+AVR_STUBS = {
+    "io.h": "#include <stdint.h>\n" +
+            "".join("#define PIN%d_bm 0x%02X\n" % (i, 1 << i) for i in range(8)),
+    "interrupt.h": "",
+    "pgmspace.h": "#include <stdint.h>\n"
+                  "#define PROGMEM\n"
+                  "#define PSTR(s) (s)\n"
+                  "#define pgm_read_byte(p) (*(const uint8_t *)(p))\n"
+                  "#define pgm_read_dword(p) (*(const uint32_t *)(p))\n",
+}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--seed", default="11638494", help="generator seed (hex)")
+    parser.add_argument("--symbols", type=int, nargs="+", default=[4],
+                        choices=range(2, 9), help="SYMBOL_COUNT values to build")
+    parser.add_argument("--cc", default=os.environ.get("CC", "cc"), help="host C compiler")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as build:
+        os.mkdir(os.path.join(build, "avr"))
+        for name, text in AVR_STUBS.items():
+            with open(os.path.join(build, "avr", name), "w") as f:
+                f.write(text)
+
+        for symbols in args.symbols:
+            binary = os.path.join(build, "bench%d" % symbols)
+            built = subprocess.run(
+                [args.cc, "-std=gnu99", "-Wall", "-DF_CPU=3333333UL",
+                 "-DSYMBOL_COUNT=%d" % symbols, "-I", build,
+                 "-I", os.path.join(ROOT, "include"), "-o", binary] +
+                [os.path.join(ROOT, source) for source in SOURCES])
+            if built.returncode:
+                return built.returncode
+            sys.stdout.write("SYMBOL_COUNT=%d seed %s\n" % (symbols, args.seed.upper()))
+            sys.stdout.flush()
+            ran = subprocess.run([binary, args.seed])
+            if ran.returncode:
+                return ran.returncode
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,36 @@
+/**
+ * @file generator_bench_host.c
+ * @brief Host entry point for the ':gen' generator benchmark
+ *
+ * Built by scripts/generator_bench.py together with the firmware's
+ * src/lsfr.c, src/generator_bench.c and src/uart_format.c, so the
+ * statistics and their formatting are the target's. UART output goes to
+ * stdout. The tick count stands still, so the cycles column reads 0;
+ * timing is only meaningful on the target.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "lsfr.h"
+#include "timer.h"
+#include "uart.h"
+
+game_t game;
+
+uint32_t ticks_now(void) {
+    return 0;
+}
+
+void uart_putc(uint8_t c) {
+    putchar(c);
+}
+
+void uart_puts(char *string) {
+    fputs(string, stdout);
+}
+
+int main(int argc, char **argv) {
+    game.seed = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 16) : 0x11638494;
+    generator_bench();
+    return 0;
+}
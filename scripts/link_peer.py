@@ -0,0 +1,312 @@
+#!/usr/bin/env python3
+"""
+Host-side peer for versus mode (-DVERSUS_MODE=1, see src/link.c).
+
+Plays the other side of the link protocol so a single board can be tested:
+    python3 scripts/link_peer.py /dev/ttyACM0            # board over USB serial
+    python3 scripts/link_peer.py --pty                   # create a pty pair
+
+With --pty the slave path is printed; connect the board bridge or a second
+instance to it. Only the standard library is used (termios, no pyserial).
+
+The peer follows the board's seed, or leads with --lead; when both lead at
+once the lower seed (then delay) wins, as on the board. Every round it
+answers the READY barrier, "plays" the sequence after the playback time
+with the configured reaction time, sends PROGRESS for each step and, with
+--error-rate, sometimes FAIL. It reports the READY barrier skew and, with
+--ping, the link round-trip time. Board text (GAME OVER, scores, console
+output) is echoed as-is.
+
+A real peer board shares the line with its own text output, so by default
+the peer sends the same text a board would (SUCCESS and score each round,
+GAME OVER, "Enter name: " and YOU WIN) and reflects every complete line of
+board text back. The board must drop it; console replies, echoes or stack
+reports in response are counted as reactions, and a non-zero count makes
+the exit status 1. --no-text turns this off.
+"""
+
+import argparse
+import os
+import random
+import select
+import sys
+import termios
+import time
+import tty
+
+# Board output that can only be a reaction to peer text (src/console.c,
+# src/stack.c)
+REACTIONS = ("commands:", "bad value", "range ", "delay:", "octave:", "seed:",
+             "RAM static:", "games:", "stack peak:")
+
+# Message types, as in include/link.h
+LINK_SEED, LINK_READY, LINK_PROGRESS, LINK_FAIL, LINK_PING, LINK_PONG = range(6)
+PAYLOAD = {LINK_SEED: 6, LINK_PROGRESS: 1}
+
+BAUD = {9600: termios.B9600, 19200: termios.B19200, 38400: termios.B38400,
+        57600: termios.B57600, 115200: termios.B115200}
+
+
+def header(kind, nibble=0):
+    return 0x80 | (kind << 4) | (nibble & 0x0F)
+
+
+def now_ms():
+    return time.monotonic() * 1000.0
+
+
+class Peer:
+    def __init__(self, fd, args):
+        self.fd = fd
+        self.args = args
+        self.rng = random.Random(args.rng_seed)
+        self.message = []
+        self.expected = 0
+        self.text = bytearray()
+        self.timers = []          # (due_ms, callback)
+        self.delay = args.delay   # Playback delay in ms, replaced by the leader's
+        self.length = 1           # Sequence length of the current round
+        self.in_game = False
+        self.lead_seed = None     # (seed, delay) while our seed leads round 1
+        self.ready_sent = None    # Round number we sent READY for
+        self.ready_sent_at = 0.0
+        self.board_ready = None   # Round number the board sent READY for
+        self.board_ready_at = 0.0
+        self.ping_at = 0.0
+        self.rtts = []
+        self.skews = []
+        self.score = 0            # Peer rounds completed, sent as board text
+        self.reactions = 0        # Board lines answering peer text
+
+    # Transport -------------------------------------------------------------
+
+    def send(self, *data):
+        os.write(self.fd, bytes(data))
+
+    def after(self, ms, callback):
+        self.timers.append((now_ms() + ms, callback))
+
+    def run_timers(self):
+        due = [t for t in self.timers if t[0] <= now_ms()]
+        self.timers = [t for t in self.timers if t[0] > now_ms()]
+        for _, callback in due:
+            callback()
+
+    def next_timeout(self):
+        if not self.timers:
+            return 0.1
+        return max(0.0, (min(t[0] for t in self.timers) - now_ms()) / 1000.0)
+
+    # Receive ---------------------------------------------------------------
+
+    def receive(self, data):
+        for byte in data:
+            if byte & 0x80:
+                self.message = [byte]
+                self.expected = 1 + PAYLOAD.get((byte >> 4) & 0x07, 0)
+            elif self.message and len(self.message) < self.expected:
+                self.message.append(byte)
+            else:
+                self.echo(byte)
+                continue
+            if len(self.message) == self.expected:
+                message, self.message = self.message, []
+                self.handle(message)
+
+    def echo(self, byte):
+        if byte == ord("\n"):
+            line = self.text.decode("ascii", "replace")
+            self.text.clear()
+            print("board: " + line)
+            if self.args.text and any(r in line for r in REACTIONS):
+                self.reactions += 1
+                print("peer: REACTION board answered peer text: %r" % line)
+            elif self.args.text:
+                self.send_text(line + "\n")  # As the peer board would print it
+        elif byte != ord("\r"):
+            self.text.append(byte)
+
+    def send_text(self, text):
+        if self.args.text:
+            os.write(self.fd, text.encode("ascii"))
+
+    def handle(self, message):
+        kind, nibble = (message[0] >> 4) & 0x07, message[0] & 0x0F
+        if kind == LINK_SEED:
+            seed = (nibble << 28) | (message[1] << 21) | (message[2] << 14) | \
+                   (message[3] << 7) | message[4]
+            delay = (message[5] << 7) | message[6]
+            if self.in_game:
+                # Crossed SEEDs: the lower one wins before round 1 is played
+                if self.lead_seed and (seed, delay) < self.lead_seed:
+                    print("peer: seeds crossed, board's %08X wins" % seed)
+                    self.delay, self.lead_seed = delay, None
+                else:
+                    print("peer: ignoring board seed %08X" % seed)
+                return
+            self.delay = delay
+            print("peer: board leads, seed %08X, delay %d ms" % (seed, self.delay))
+            self.new_game()
+        elif kind == LINK_READY:
+            self.board_ready, self.board_ready_at = nibble, now_ms()
+            if self.ready_sent != nibble:
+                self.after(self.args.ready_lag, self.send_ready)
+            self.check_barrier()
+        elif kind == LINK_PROGRESS:
+            print("peer: board at step %d/%d" % (message[1], self.length))
+        elif kind == LINK_FAIL:
+            print("peer: board failed, peer wins round %d" % self.length)
+            self.send_text("YOU WIN\n%d\n" % self.score)
+            self.end_game()
+        elif kind == LINK_PING:
+            self.send(header(LINK_PONG))
+        elif kind == LINK_PONG:
+            rtt = now_ms() - self.ping_at
+            self.rtts.append(rtt)
+            print("peer: rtt %.1f ms" % rtt)
+
+    # Game ------------------------------------------------------------------
+
+    def lead(self):
+        seed = self.rng.getrandbits(32) or 1
+        print("peer: leading, seed %08X, delay %d ms" % (seed, self.delay))
+        self.lead_seed = (seed, self.delay)
+        self.send(header(LINK_SEED, seed >> 28), (seed >> 21) & 0x7F,
+                  (seed >> 14) & 0x7F, (seed >> 7) & 0x7F, seed & 0x7F,
+                  (self.delay >> 7) & 0x7F, self.delay & 0x7F)
+        self.new_game()
+
+    def new_game(self):
+        self.in_game = True
+        self.length = 1
+        self.score = 0
+        self.ready_sent = None
+        self.send_ready()
+
+    def end_game(self):
+        self.in_game = False
+        self.lead_seed = None
+        self.timers = []
+        self.ready_sent = self.board_ready = None
+        if self.args.lead:
+            self.after(2000, self.lead)
+
+    def send_ready(self):
+        round_ = self.length & 0x0F
+        if not self.in_game or self.ready_sent == round_:
+            return
+        self.ready_sent, self.ready_sent_at = round_, now_ms()
+        self.send(header(LINK_READY, round_))
+        self.check_barrier()
+
+    def check_barrier(self):
+        round_ = self.length & 0x0F
+        if self.ready_sent != round_ or self.board_ready != round_:
+            return
+        # The board starts playback when it receives the later of the two
+        skew = abs(self.ready_sent_at - self.board_ready_at)
+        self.skews.append(skew)
+        print("peer: round %d synced, READY skew %.1f ms" % (self.length, skew))
+        self.lead_seed = None
+        self.board_ready = None
+        self.after(self.length * self.delay, lambda: self.play_step(1))
+
+    def play_step(self, position):
+        if not self.in_game:
+            return
+        reaction = max(0.0, self.rng.gauss(self.args.reaction, self.args.reaction / 4))
+        if self.rng.random() < self.args.error_rate:
+            self.after(reaction, self.fail)
+            return
+        self.after(reaction, lambda: self.step_done(position))
+
+    def step_done(self, position):
+        if not self.in_game:
+            return
+        self.send(header(LINK_PROGRESS), position & 0x7F)
+        if position < self.length:
+            self.play_step(position + 1)
+        else:
+            self.length += 1
+            self.score += 1
+            self.send_text("SUCCESS\n%d\n" % self.score)
+            self.after(self.delay, self.send_ready)
+
+    def fail(self):
+        print("peer: mistake in round %d, board wins" % self.length)
+        self.send(header(LINK_FAIL))
+        self.send_text("GAME OVER\n%d\nEnter name: " % self.score)
+        self.end_game()
+
+    def ping(self):
+        self.ping_at = now_ms()
+        self.send(header(LINK_PING))
+        self.after(self.args.ping, self.ping)
+
+    def summary(self):
+        for name, values in (("READY skew", self.skews), ("rtt", self.rtts)):
+            if values:
+                print("peer: %s min %.1f avg %.1f max %.1f ms (%d samples)" % (
+                    name, min(values), sum(values) / len(values), max(values), len(values)))
+        if self.args.text:
+            print("peer: %d board reactions to peer text" % self.reactions)
+
+
+def open_port(args):
+    if args.pty:
+        master, slave = os.openpty()
+        tty.setraw(slave)
+        print("peer: pty %s" % os.ttyname(slave))
+        return master
+    fd = os.open(args.port, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    attrs[4] = attrs[5] = BAUD[args.baud]
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("port", nargs="?", help="serial device of the board")
+    parser.add_argument("--pty", action="store_true", help="create a pty instead of opening a port")
+    parser.add_argument("--baud", type=int, default=9600, choices=sorted(BAUD))
+    parser.add_argument("--lead", action="store_true", help="send the seed instead of following")
+    parser.add_argument("--delay", type=int, default=500, help="playback delay in ms when leading")
+    parser.add_argument("--reaction", type=float, default=400.0, help="mean reaction time in ms")
+    parser.add_argument("--error-rate", type=float, default=0.02, help="chance of a mistake per step")
+    parser.add_argument("--ready-lag", type=float, default=0.0, help="ms before answering READY")
+    parser.add_argument("--ping", type=float, default=0.0, help="ping interval in ms (0 = off)")
+    parser.add_argument("--rng-seed", type=int, help="seed for reproducible play")
+    parser.add_argument("--no-text", dest="text", action="store_false",
+                        help="do not send board text over the link")
+    args = parser.parse_args()
+    if not args.pty and not args.port:
+        parser.error("give a serial port or --pty")
+
+    fd = open_port(args)
+    peer = Peer(fd, args)
+    if args.lead:
+        peer.lead()
+    if args.ping:
+        peer.after(args.ping, peer.ping)
+
+    try:
+        while True:
+            ready, _, _ = select.select([fd], [], [], peer.next_timeout())
+            if ready:
+                try:
+                    data = os.read(fd, 64)
+                except OSError:
+                    data = b""  # pty with nothing attached yet
+                peer.receive(data)
+            peer.run_timers()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        peer.summary()
+    return 1 if peer.reactions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
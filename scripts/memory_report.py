@@ -0,0 +1,113 @@
+"""
+PlatformIO post-build script: SRAM and flash usage per module and per symbol.
+
+Enabled from platformio.ini with
+    extra_scripts = post:scripts/memory_report.py
+
+The linker map gives the size each object file contributes to every output
+section; avr-nm gives the size of every symbol. Flash is .text + .data
+(initialisers are stored in flash), SRAM is .data + .bss + .noinit.
+The remaining SRAM is what is left for the stack and any new buffers;
+compare it with the stack peak reported at runtime by the 'm' UART key.
+"""
+
+import os
+import re
+import subprocess
+
+Import("env")  # noqa: F821  (provided by PlatformIO/SCons)
+
+RAM_SIZE = 2048
+FLASH_SIZE = 16384
+
+MAP_PATH = os.path.join(env.subst("$BUILD_DIR"), "firmware.map")  # noqa: F821
+env.Append(LINKFLAGS=["-Wl,-Map," + MAP_PATH])  # noqa: F821
+
+# Input section names; COMMON holds tentative definitions and lands in .bss
+SECTION_RE = re.compile(r"^\s*(?:\.(text|data|bss|noinit|rodata)\S*|(COMMON))\s*$")
+ENTRY_RE = re.compile(
+    r"^\s*(?:\.(text|data|bss|noinit|rodata)\S*|(COMMON))?\s+0x[0-9a-f]+\s+0x([0-9a-f]+)\s+(\S+\.(?:o|a\(.+\)))\s*$"
+)
+
+
+def parse_map(path):
+    """Returns {module: {"flash": n, "sram": n}} from a GNU ld map file."""
+    modules = {}
+    pending = None
+    in_map = False
+
+    with open(path) as f:
+        for line in f:
+            if line.startswith("Linker script and memory map"):
+                in_map = True
+                continue
+            if not in_map:
+                continue
+
+            header = SECTION_RE.match(line)
+            if header:
+                pending = header.group(1) or "bss"
+                continue
+
+            entry = ENTRY_RE.match(line)
+            if not entry:
+                pending = None
+                continue
+
+            section = entry.group(1) or ("bss" if entry.group(2) else pending)
+            pending = None
+            if section is None:
+                continue
+
+            size = int(entry.group(3), 16)
+            if size == 0:
+                continue
+
+            module = os.path.basename(entry.group(4))
+            usage = modules.setdefault(module, {"flash": 0, "sram": 0})
+            if section in ("text", "rodata"):
+                usage["flash"] += size
+            elif section == "data":
+                usage["flash"] += size
+                usage["sram"] += size
+            else:
+                usage["sram"] += size
+
+    return modules
+
+
+def parse_symbols(nm, elf):
+    """Returns a list of (size, type, name) sorted by size, largest first."""
+    output = subprocess.check_output([nm, "-S", "--size-sort", "-C", elf])
+    symbols = []
+    for line in output.decode().splitlines():
+        parts = line.split()
+        if len(parts) == 4:
+            symbols.append((int(parts[1], 16), parts[2], parts[3]))
+    return sorted(symbols, reverse=True)
+
+
+def memory_report(source, target, env):
+    elf = str(target[0])
+    nm = env.subst("$CC").replace("gcc", "nm")
+
+    print("\n===== Memory usage per module =====")
+    print("%-32s %8s %8s" % ("module", "flash", "sram"))
+    modules = parse_map(MAP_PATH)
+    total_flash = total_sram = 0
+    for name, usage in sorted(modules.items(), key=lambda m: -m[1]["flash"]):
+        print("%-32s %8d %8d" % (name, usage["flash"], usage["sram"]))
+        total_flash += usage["flash"]
+        total_sram += usage["sram"]
+    print("%-32s %8d %8d" % ("total", total_flash, total_sram))
+    print("flash free: %d of %d, sram free for stack: %d of %d" % (
+        FLASH_SIZE - total_flash, FLASH_SIZE, RAM_SIZE - total_sram, RAM_SIZE))
+
+    print("\n===== Memory usage per symbol =====")
+    print("%8s %-6s %s" % ("size", "region", "symbol"))
+    for size, kind, name in parse_symbols(nm, elf):
+        region = "sram" if kind in "bBdDvV" else "flash"
+        print("%8d %-6s %s" % (size, region, name))
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", memory_report)  # noqa: F821
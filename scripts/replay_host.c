@@ -0,0 +1,112 @@
+/**
+ * @file replay_host.c
+ * @brief Host harness feeding a replay log through the firmware input path
+ *
+ * Built by scripts/replay_run.py together with the firmware's src/replay.c
+ * (REPLAY_MODE=REPLAY_PLAYBACK), src/lsfr.c and src/uart_format.c. The
+ * script copies the button state variables and check_edge() from
+ * src/input.c, and check_button_input() from src/main.c, into
+ * replay_input.inc verbatim, so the log goes through the same edge
+ * detection and press handling as on the target.
+ *
+ * The tick count is simulated: each tick makes one main loop pass
+ * (replay_poll(), check_edge(), check_button_input()). The rest of the
+ * game is not run, so every pass counts as the INPUT stage and SYNC and
+ * ADC events are consumed as soon as they come up. Prints each edge and
+ * accepted press with its tick, then the "#D" line replay.c sends at the
+ * end of the log. Exit status: 0 when the whole log was replayed.
+ */
+
+#include <stdio.h>
+#include "input.h"
+#include "replay.h"
+#include "replay_log.h"
+#include "typeahead.h"
+#include "reaction.h"
+#include "console.h"
+#include "lsfr.h"
+#include "timer.h"
+#include "uart.h"
+
+// Ticks simulated past the last event, so its press can complete
+#define SETTLE_TICKS 1000
+
+game_t game;
+console_counters_t counters;
+uint8_t GPIOR0;
+
+static uint32_t tick;       // Simulated 1ms tick count
+static uint8_t finished;    // Set once replay.c reported the end
+
+#include "replay_input.inc"
+
+uint32_t ticks_now(void) {
+    return tick;
+}
+
+void uart_putc(uint8_t c) {
+    if (c == '#') {
+        finished = 1;   // Playback only sends the "#D" line
+    }
+    putchar(c);
+}
+
+void uart_puts(char *string) {
+    while (*string) {
+        uart_putc(*string++);
+    }
+}
+
+/**
+ * Total ticks spanned by the log, WAIT continuations included
+ */
+static uint32_t log_ticks(void) {
+    static const replay_event events[] = REPLAY_LOG_EVENTS;
+    uint32_t total = 0;
+
+    for (const replay_event *event = events; event->type != EVENT_END; event++) {
+        total += event->type == EVENT_WAIT ? (uint32_t)event->ticks << 16 : event->ticks;
+    }
+    return total;
+}
+
+/**
+ * Prints one line per button set in a mask
+ */
+static void report(const char *what, uint8_t pins) {
+    for (uint8_t i = 0; i < SYMBOL_COUNT; i++) {
+        if (pins & mapped_array[i].pin) {
+            printf("%8lu %s S%u\n", (unsigned long)tick, what, i + 1);
+        }
+    }
+}
+
+int main(void) {
+    const uint32_t end = log_ticks() + SETTLE_TICKS;
+
+    game.stage = INPUT;
+    replay_start();     // Loads REPLAY_LOG_SEED
+    game.state_sequence = game.seed;
+    printf("seed %08lX, %lu ticks\n", (unsigned long)game.seed, (unsigned long)end);
+
+    for (tick = 0; tick <= end; tick++) {
+        const uint16_t position = game.sequence_position;
+
+        replay_sync();
+        replay_adc(0);
+        replay_poll();
+        check_edge();
+        report("down", pb_falling);
+        report("up", pb_rising);
+        check_button_input();
+        if (game.sequence_position != position) {
+            printf("%8lu press S%u\n", (unsigned long)tick, game.button - S1 + 1);
+        }
+    }
+
+    if (!finished) {
+        printf("replay_host: log not finished after %lu ticks\n", (unsigned long)end);
+        return 1;
+    }
+    return 0;
+}
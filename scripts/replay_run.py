@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""
+Replays a recorded session on the host through the firmware input path.
+
+    python3 scripts/replay_run.py [capture.txt] [--symbols 4] [--cc gcc]
+
+The capture is serial output from a REPLAY_MODE=1 build: the first "#S"
+line gives the seed and every "#E" line one event; other lines are
+ignored, so a raw terminal log works. Without a capture the session in
+include/replay_log.h is replayed.
+
+The button state variables and check_edge() from src/input.c and
+check_button_input() from src/main.c are copied verbatim next to
+scripts/replay_host.c, which runs them with src/replay.c in playback mode
+on a simulated tick. Prints every edge and accepted press with its tick
+and exits non-zero if the build fails or the log is not replayed to the
+end.
+
+Only the few avr-libc names these files use are stubbed, in a temporary
+directory.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCES = ["src/replay.c", "src/lsfr.c", "src/uart_format.c", "scripts/replay_host.c"]
+
+# (file, pattern) pairs copied into replay_input.inc, in order
+EXTRACTS = [
+    ("src/input.c", r"^uint8_t pb_sample = 0xFF;$.*?^void check_edge\(void\) \{$.*?^\}$"),
+    ("src/main.c", r"^static inline void check_button_input\(void\) \{$.*?^\}$"),
+]
+
+AVR_STUBS = {
+    "io.h": "#pragma once\n"
+            "#include <stdint.h>\n"
+            "typedef struct { uint8_t IN; } PORT_t;\n"
+            "extern PORT_t PORTA;\n"
+            "extern uint8_t GPIOR0, GPIOR1, GPIOR2, GPIOR3;\n" +
+            "".join("#define PIN%d_bm 0x%02X\n" % (i, 1 << i) for i in range(8)),
+    "interrupt.h": "",
+    "pgmspace.h": "#include <stdint.h>\n"
+                  "#define PROGMEM\n"
+                  "#define PSTR(s) (s)\n"
+                  "#define pgm_read_byte(p) (*(const uint8_t *)(p))\n"
+                  "#define pgm_read_dword(p) (*(const uint32_t *)(p))\n",
+}
+
+
+def log_header(path):
+    """Converts a capture into the replay_log.h format."""
+    seed = None
+    events = []
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith("#S") and seed is None:
+                seed = int(line[2:10], 16)
+            elif re.fullmatch(r"#E[0-9A-Fa-f]{8}", line):
+                events.append("    { 0x%s, 0x%s, 0x%s }, \\\n" % (line[2:6], line[6:8], line[8:10]))
+    if seed is None:
+        raise SystemExit("replay_run: no #S line in %s" % path)
+    return ("#define REPLAY_LOG_SEED 0x%08X\n"
+            "#define REPLAY_LOG_EVENTS { \\\n%s    { 0, EVENT_END, 0 } }\n"
+            % (seed, "".join(events)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("capture", nargs="?", help="serial capture with #S/#E lines")
+    parser.add_argument("--symbols", type=int, default=4, choices=range(2, 9),
+                        help="SYMBOL_COUNT of the recording build")
+    parser.add_argument("--cc", default=os.environ.get("CC", "cc"), help="host C compiler")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as build:
+        os.mkdir(os.path.join(build, "avr"))
+        for name, text in AVR_STUBS.items():
+            with open(os.path.join(build, "avr", name), "w") as f:
+                f.write(text)
+
+        with open(os.path.join(build, "replay_input.inc"), "w") as inc:
+            for source, pattern in EXTRACTS:
+                with open(os.path.join(ROOT, source), newline="") as f:
+                    match = re.search(pattern, f.read().replace("\r\n", "\n"), re.M | re.S)
+                if not match:
+                    print("replay_run: code to copy not found in %s" % source)
+                    return 1
+                inc.write(match.group(0) + "\n\n")
+
+        if args.capture:
+            with open(os.path.join(build, "replay_log.h"), "w") as f:
+                f.write(log_header(args.capture))
+
+        binary = os.path.join(build, "replay_host")
+        built = subprocess.run(
+            [args.cc, "-std=gnu99", "-Wall", "-DF_CPU=3333333UL", "-DREPLAY_MODE=2",
+             "-Wno-address-of-packed-member",
+             "-DSYMBOL_COUNT=%d" % args.symbols, "-I", build,
+             "-I", os.path.join(ROOT, "include"), "-o", binary] +
+            [os.path.join(ROOT, source) for source in SOURCES])
+        if built.returncode:
+            return built.returncode
+        sys.stdout.flush()
+        return subprocess.run([binary]).returncode
+
+
+if __name__ == "__main__":
+    sys.exit(main())
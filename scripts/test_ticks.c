@@ -0,0 +1,114 @@
+/**
+ * @file test_ticks.c
+ * @brief Host test for ticks_now(), ticks_since() and deadline_reached()
+ *
+ * Built and run by scripts/test_ticks.py, which copies ticks_now() out of
+ * src/timer.c into ticks_now.inc so the code under test is the firmware's.
+ *
+ * On the ATtiny the 32-bit tick count is loaded a byte at a time, low
+ * byte first, and the TCB0 ISR can run between any two loads. Here
+ * tick_count expands to tick_read(), which assembles the value the same
+ * way and can increment the counter after a chosen byte load.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "timer.h"
+
+static uint32_t counter;        // Value the ISR would hold in tick_count
+static int inject_at = -1;      // Byte load after which to tick, -1 = never
+static int loads;               // Byte loads since the injection was armed
+static int failures;
+
+/**
+ * Reads the counter as four byte loads, ticking once if armed
+ */
+static uint32_t tick_read(void) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= ((counter >> (8 * i)) & 0xFF) << (8 * i);
+        if (loads++ == inject_at) {
+            counter++;  // The ISR runs here
+        }
+    }
+    return value;
+}
+
+#define tick_count tick_read()
+#include "ticks_now.inc"
+
+static void check(int ok, const char *what, uint32_t a, uint32_t b) {
+    if (!ok) {
+        printf("FAIL %s: %08lX %08lX\n", what, (unsigned long)a, (unsigned long)b);
+        failures++;
+    }
+}
+
+/**
+ * A tick between any two byte loads gives the old or the new count, never
+ * a torn mix, including when the increment carries into every byte.
+ */
+static void test_torn_reads(void) {
+    static const uint32_t starts[] = {
+        0x00000000, 0x000000FF, 0x0000FFFF, 0x00FFFFFF, 0xFFFFFFFF, 0x12FF34FF
+    };
+    for (unsigned s = 0; s < sizeof starts / sizeof starts[0]; s++) {
+        for (int at = 0; at < 8; at++) {  // Either of the first two reads
+            counter = starts[s];
+            loads = 0;
+            inject_at = at;
+            uint32_t now = ticks_now();
+            check(now == starts[s] || now == starts[s] + 1, "torn read", starts[s], now);
+            check(counter == starts[s] + 1, "tick lost", starts[s], counter);
+        }
+    }
+    inject_at = -1;
+}
+
+/**
+ * Elapsed time is correct across the 32-bit wrap
+ */
+static void test_ticks_since(void) {
+    counter = 0x00000010;
+    check(ticks_since(0xFFFFFFF0) == 0x20, "since across wrap", 0xFFFFFFF0, counter);
+    check(ticks_since(0x00000010) == 0, "since now", 0x00000010, counter);
+    counter = 0xFFFFFFFF;
+    check(ticks_since(0) == 0xFFFFFFFF, "since reset", 0, counter);
+}
+
+/**
+ * Deadlines set just before the wrap fire after it, not at once
+ */
+static void test_deadline_reached(void) {
+    static const uint32_t bases[] = { 0x00000000, 0x7FFFFFF0, 0xFFFFFFF0 };
+    for (unsigned b = 0; b < sizeof bases / sizeof bases[0]; b++) {
+        uint32_t deadline = bases[b] + 32;  // Wraps for the last base
+
+        counter = bases[b];
+        check(!deadline_reached(deadline), "reached at start", deadline, counter);
+        counter = deadline - 1;
+        check(!deadline_reached(deadline), "reached early", deadline, counter);
+        counter = deadline;
+        check(deadline_reached(deadline), "missed on time", deadline, counter);
+        counter = deadline + 1000;
+        check(deadline_reached(deadline), "missed late", deadline, counter);
+    }
+
+    /* Passed deadlines read as reached for up to 2^31 - 1 ticks (~24 days) */
+    counter = 0x7FFFFFFF;
+    check(deadline_reached(0), "reached at limit", 0, counter);
+    counter = 0x80000000;
+    check(!deadline_reached(0), "limit moved", 0, counter);
+}
+
+int main(void) {
+    test_torn_reads();
+    test_ticks_since();
+    test_deadline_reached();
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("ticks: all tests passed\n");
+    return 0;
+}
@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+"""
+Builds and runs the host test for the tick time base (scripts/test_ticks.c).
+
+    python3 scripts/test_ticks.py [--cc gcc]
+
+ticks_now() is copied verbatim from src/timer.c, so the test exercises the
+firmware code rather than a copy of it; include/timer.h provides
+ticks_since() and deadline_reached(). Exits non-zero if the build or any
+check fails.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+FUNCTION_RE = re.compile(r"^uint32_t ticks_now\(void\) \{$.*?^\}$", re.M | re.S)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--cc", default=os.environ.get("CC", "cc"), help="host C compiler")
+    args = parser.parse_args()
+
+    with open(os.path.join(ROOT, "src", "timer.c"), newline="") as f:
+        match = FUNCTION_RE.search(f.read().replace("\r\n", "\n"))
+    if not match:
+        print("test_ticks: ticks_now() not found in src/timer.c")
+        return 1
+
+    with tempfile.TemporaryDirectory() as build:
+        with open(os.path.join(build, "ticks_now.inc"), "w") as f:
+            f.write(match.group(0) + "\n")
+        binary = os.path.join(build, "test_ticks")
+        built = subprocess.run([args.cc, "-std=c99", "-Wall", "-Wextra",
+                                "-I", os.path.join(ROOT, "include"), "-I", build,
+                                os.path.join(ROOT, "scripts", "test_ticks.c"), "-o", binary])
+        if built.returncode:
+            return built.returncode
+        return subprocess.run([binary]).returncode
+
+
+if __name__ == "__main__":
+    sys.exit(main())
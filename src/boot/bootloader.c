@@ -0,0 +1,216 @@
+/**
+ * @file bootloader.c
+ * @brief Resident serial bootloader for field updates over USART0
+ *
+ * Lives in the BOOT section (first BOOT_SIZE bytes of flash) and is built
+ * on its own with [env:bootloader]; the application is linked after it.
+ *
+ * Entry:
+ * - After a software reset, requested by the application's :boot console
+ *   command, the bootloader waits for an upload (about 5s)
+ * - With no application present (erased reset vector) it waits forever
+ * - Otherwise it jumps straight to the application
+ *
+ * Page frames are streamed straight into the NVM page buffer while the
+ * CRC is updated byte by byte, so a verified page is committed with a
+ * single erase/write command and no copy. The CPU is halted while flash
+ * is programmed, so the host waits for each ACK before sending the next
+ * page.
+ *
+ * scripts/boot_upload.py --simulate builds this file for the host
+ * (scripts/boot_host.c) and uploads into it.
+ */
+
+#include <avr/io.h>
+#include <avr/cpufunc.h>
+#include <util/crc16.h>
+#include "boot.h"
+
+#if !BOOT_SIZE
+#error "Build the bootloader with -DBOOT_SIZE set to FUSE.BOOTSIZE * 256"
+#endif
+
+#define BOOT_F_CPU 20000000UL
+#define BOOT_BAUD_VALUE ((64 * BOOT_F_CPU + 8 * BOOT_BAUD) / (16 * BOOT_BAUD))
+
+// Busy-wait loop counts for the receive timeouts (~10 cycles per loop)
+#define BOOT_ENTRY_TIMEOUT (BOOT_F_CPU / 2)    // ~5s for the first frame
+#define BOOT_BYTE_TIMEOUT (BOOT_F_CPU / 100)   // ~50ms between frame bytes
+
+#define APP_VECTOR (*(const volatile uint16_t *)(MAPPED_PROGMEM_START + BOOT_SIZE))
+
+static uint8_t timed_out;   // Flag set when rx() gave up waiting
+static uint16_t crc;        // CRC of the frame being received
+
+/**
+ * Receives one byte, updating the frame CRC
+ *
+ * @param timeout Busy-wait loops before giving up
+ * @return Byte received, or 0 with timed_out set
+ */
+static uint8_t rx(uint32_t timeout) {
+    while (!(USART0.STATUS & USART_RXCIF_bm)) {
+        if (!--timeout) {
+            timed_out = 1;
+            return 0;
+        }
+    }
+    uint8_t byte = USART0.RXDATAL;
+    crc = _crc_xmodem_update(crc, byte);
+    return byte;
+}
+
+/**
+ * Transmits one byte
+ */
+static void tx(uint8_t byte) {
+    while (!(USART0.STATUS & USART_DREIF_bm));
+    USART0.TXDATAL = byte;
+}
+
+/**
+ * Receives the two frame CRC bytes and checks them
+ *
+ * @return Non-zero if the frame arrived complete and intact
+ */
+static uint8_t frame_ok(void) {
+    rx(BOOT_BYTE_TIMEOUT);
+    rx(BOOT_BYTE_TIMEOUT);
+    return !timed_out && crc == 0;  // CRC over data plus its own CRC is zero
+}
+
+/**
+ * Receives a page frame into the NVM page buffer and programs it
+ *
+ * @return BOOT_ACK once the page is written, BOOT_NAK otherwise
+ */
+static uint8_t receive_page(void) {
+    uint16_t address = rx(BOOT_BYTE_TIMEOUT);
+    address |= (uint16_t)rx(BOOT_BYTE_TIMEOUT) << 8;
+
+    /* Never overwrite the bootloader or run past the end of flash */
+    uint8_t valid = address >= BOOT_SIZE && address < PROGMEM_SIZE &&
+                    !(address & (PROGMEM_PAGE_SIZE - 1));
+    volatile uint8_t *page = (volatile uint8_t *)(MAPPED_PROGMEM_START + address);
+
+    for (uint8_t i = 0; i < PROGMEM_PAGE_SIZE; i++) {
+        uint8_t byte = rx(BOOT_BYTE_TIMEOUT);
+        if (valid) {
+            page[i] = byte;  // Fills the page buffer, not flash
+        }
+    }
+
+    if (!frame_ok() || !valid) {
+        _PROTECTED_WRITE_SPM(NVMCTRL.CTRLA, NVMCTRL_CMD_PAGEBUFCLR_gc);
+        return BOOT_NAK;
+    }
+
+    _PROTECTED_WRITE_SPM(NVMCTRL.CTRLA, NVMCTRL_CMD_PAGEERASEWRITE_gc);
+    while (NVMCTRL.STATUS & NVMCTRL_FBUSY_bm);
+    return BOOT_ACK;
+}
+
+/**
+ * Checks the CRC of the programmed image against the host's
+ *
+ * @return BOOT_ACK if the image matches, BOOT_NAK otherwise
+ */
+static uint8_t verify_image(void) {
+    uint16_t length = rx(BOOT_BYTE_TIMEOUT);
+    length |= (uint16_t)rx(BOOT_BYTE_TIMEOUT) << 8;
+    uint16_t expected = rx(BOOT_BYTE_TIMEOUT);
+    expected |= (uint16_t)rx(BOOT_BYTE_TIMEOUT) << 8;
+
+    if (!frame_ok() || length > PROGMEM_SIZE - BOOT_SIZE) {
+        return BOOT_NAK;
+    }
+
+    const uint8_t *image = (const uint8_t *)(MAPPED_PROGMEM_START + BOOT_SIZE);
+    uint16_t actual = 0;
+    while (length--) {
+        actual = _crc_xmodem_update(actual, *image++);
+    }
+    return actual == expected ? BOOT_ACK : BOOT_NAK;
+}
+
+/**
+ * Restores reset defaults and jumps to the application
+ */
+static void start_app(void) {
+    if (USART0.CTRLB) {
+        while (!(USART0.STATUS & USART_TXCIF_bm));  // Drain the last reply
+    }
+    USART0.CTRLB = 0;
+    USART0.BAUD = 0;
+    PORTB.DIRCLR = PIN2_bm;
+    _PROTECTED_WRITE(CLKCTRL.MCLKCTRLB, CLKCTRL_PDIV_6X_gc | CLKCTRL_PEN_bm);
+
+    ((void (*)(void))(BOOT_SIZE / 2))();  // Word address of the reset vector
+}
+
+/**
+ * Bootloader entry point
+ */
+int main(void) {
+    uint8_t reset_flags = RSTCTRL.RSTFR;
+    RSTCTRL.RSTFR = reset_flags;  // Clear so the next reset is judged afresh
+
+    uint8_t app_present = APP_VECTOR != 0xFFFF;
+    if (app_present && !(reset_flags & RSTCTRL_SWRF_bm)) {
+        start_app();
+    }
+
+    _PROTECTED_WRITE(CLKCTRL.MCLKCTRLB, 0);  // Full 20MHz for BOOT_BAUD
+    PORTB.DIRSET = PIN2_bm;                  // TXD
+    USART0.BAUD = BOOT_BAUD_VALUE;
+    USART0.CTRLB = USART_RXEN_bm | USART_TXEN_bm;
+
+    uint8_t uploading = 0;
+    while (1) {
+        timed_out = 0;
+        crc = 0;
+        uint8_t command = rx(BOOT_ENTRY_TIMEOUT);
+
+        if (timed_out) {
+            if (app_present && !uploading) {
+                start_app();  // Nobody is uploading, resume the application
+            }
+            continue;
+        }
+
+        switch (command) {
+        case BOOT_CMD_IDENTIFY:
+            if (frame_ok()) {
+                uploading = 1;
+                tx(BOOT_ACK);
+                tx(PROGMEM_PAGE_SIZE);
+                tx(BOOT_SIZE / 256);
+            }
+            break;
+
+        case BOOT_CMD_PAGE:
+            uploading = 1;
+            app_present = 0;  // Partially written until verified
+            tx(receive_page());
+            break;
+
+        case BOOT_CMD_VERIFY: {
+            uint8_t reply = verify_image();
+            app_present = reply == BOOT_ACK && APP_VECTOR != 0xFFFF;
+            tx(reply);
+            break;
+        }
+
+        case BOOT_CMD_GO:
+            if (frame_ok() && app_present) {
+                tx(BOOT_ACK);
+                start_app();
+            }
+            tx(BOOT_NAK);
+            break;
+
+        default:
+            break;  // Not a frame start: resynchronise on the next byte
+        }
+    }
+}
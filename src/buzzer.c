@@ -6,9 +6,12 @@
  * - Playing different musical notes (E high, C#, A, E low)
  * - Adjusting frequency/pitch
  * - Turning the buzzer on and off
+ * - Two independent voices in TCA0 split mode (DUAL_VOICE builds)
  */
 
 #include "buzzer.h"
+#include "clock.h"
+#include "clock_governor.h"
 #include <avr/io.h>
 #include <stdint.h>
 
@@ -21,15 +24,27 @@ volatile int8_t frequency = 0;
  * Lower period values produce higher frequencies/pitches.
  * scaled by three to avoid any turnication
  * 
- * (1 / F)   / (1 / (( 20MHz * 10^6 ) / 12) 
- * NOTE TCA0.SINGLE.CTRLA = TCA_SINGLE_CLKSEL_DIV2_gc; 
- * prescaler IS 2
- */
-const uint32_t base_periods[4] = {
-    [E_HIGH] = 36024,   // E high note 370Hz
-    [C_SHARP] = 42840,  // C# note 311Hz
-    [A] = 26984,        // A note 494Hz
-    [E_LOW] = 72056     // E low note 185hz
+ * Generated at compile time from F_CPU and the TCA0 prescaler chosen
+ * in clock.h: (F_CPU / TONE_DIV) / F, shifted left by scaling_factor.
+ * One tone per symbol; alphabets over four add notes for S5-S8.
+ */
+const uint32_t base_periods[NOTE_COUNT] = {
+    [E_HIGH] = TONE_PERIOD(NOTE_E_HIGH_CHZ),     // E high note 370Hz
+    [C_SHARP] = TONE_PERIOD(NOTE_C_SHARP_CHZ),   // C# note 311Hz
+    [A] = TONE_PERIOD(NOTE_A_CHZ),               // A note 494Hz
+    [E_LOW] = TONE_PERIOD(NOTE_E_LOW_CHZ),       // E low note 185hz
+#if SYMBOL_COUNT > 4
+    [B] = TONE_PERIOD(NOTE_B_CHZ),               // B note 247Hz
+#endif
+#if SYMBOL_COUNT > 5
+    [F_SHARP] = TONE_PERIOD(NOTE_F_SHARP_CHZ),   // F# note 277Hz
+#endif
+#if SYMBOL_COUNT > 6
+    [G_SHARP] = TONE_PERIOD(NOTE_G_SHARP_CHZ),   // G# note 415Hz
+#endif
+#if SYMBOL_COUNT > 7
+    [C_SHARP_HIGH] = TONE_PERIOD(NOTE_C_SHARP_HIGH_CHZ)  // High C# note 554Hz
+#endif
 };
 
 /**
@@ -67,6 +82,114 @@ void decrease_frequency(void) {
         frequency--;
 }
 
+#if DUAL_VOICE
+
+/* Tone period of each voice in F_CPU cycles, 0 when silent */
+static uint32_t voice_cycles[2];
+
+/* Prescaler shift for each TCA_SPLIT_CLKSEL setting, DIV1 to DIV1024 */
+static const uint8_t prescaler_shift[8] = {0, 1, 2, 3, 4, 6, 8, 10};
+
+/**
+ * Reprograms both 8-bit halves of TCA0 for the current voices
+ * 
+ * Auto-ranges the shared prescaler: the smallest one at which the longer
+ * period fits in 8 bits, so the lower note keeps the most resolution.
+ * The waveform runs in hardware; this is only called on note changes
+ * and clock governor switches, converting to the current CLK_PER.
+ */
+static void voices_update(void) {
+    const uint32_t longest = clock_cycles(voice_cycles[0] > voice_cycles[1] ?
+                                          voice_cycles[0] : voice_cycles[1]);
+    uint8_t clksel = 0;
+    while (clksel < 7 && (longest >> prescaler_shift[clksel]) > 256) {
+        clksel++;
+    }
+
+    uint8_t periods[2];
+    for (uint8_t voice = 0; voice < 2; voice++) {
+        uint32_t period = clock_cycles(voice_cycles[voice]) >> prescaler_shift[clksel];
+        periods[voice] = period > 256 ? 255 : period < 2 ? 1 : period - 1;
+    }
+
+    TCA0.SPLIT.CTRLA = (clksel << TCA_SPLIT_CLKSEL_gp) | TCA_SPLIT_ENABLE_bm;
+    TCA0.SPLIT.LPER = periods[0];
+    TCA0.SPLIT.LCMP0 = (periods[0] + 1) >> 1;  // 50% duty
+    TCA0.SPLIT.HPER = periods[1];
+    TCA0.SPLIT.HCMP0 = (periods[1] + 1) >> 1;
+
+    /* A silent voice has its output disabled, so the pin idles low */
+    TCA0.SPLIT.CTRLB = (voice_cycles[0] ? TCA_SPLIT_LCMP0EN_bm : 0) |
+                       (voice_cycles[1] ? TCA_SPLIT_HCMP0EN_bm : 0);
+}
+
+/**
+ * Reprograms the voices for a new CPU clock level
+ */
+void buzzer_retune(void) {
+    voices_update();
+}
+
+/**
+ * Starts a note on one voice
+ * 
+ * @param voice 0 (buzzer, PB0) or 1 (PA3)
+ * @param note The musical note to play, with the pitch shift applied
+ */
+void voice_on(uint8_t voice, Note note) {
+    voice_cycles[voice & 1] = period_map(note) * TONE_DIV;
+    voices_update();
+}
+
+/**
+ * Silences one voice
+ * 
+ * @param voice 0 (buzzer, PB0) or 1 (PA3)
+ */
+void voice_off(uint8_t voice) {
+    voice_cycles[voice & 1] = 0;
+    voices_update();
+}
+
+/**
+ * Plays two notes at once, for feedback jingles
+ * 
+ * @param low Note for voice 0
+ * @param high Note for voice 1
+ */
+void buzzer_chord(Note low, Note high) {
+    voice_cycles[0] = period_map(low) * TONE_DIV;
+    voice_cycles[1] = period_map(high) * TONE_DIV;
+    voices_update();
+}
+
+/**
+ * Silences both voices
+ */
+void buzzer_chord_off(void) {
+    voice_cycles[0] = 0;
+    voice_cycles[1] = 0;
+    voices_update();
+}
+
+/**
+ * Turns on the buzzer (voice 0) with the specified note
+ * 
+ * @param note The musical note to play
+ */
+void buzzer_on(Note note) {
+    voice_on(0, note);
+}
+
+/**
+ * Turns off the buzzer (voice 0)
+ */
+void buzzer_off(void) {
+    voice_off(0);
+}
+
+#else
+
 /**
  * Turns on the buzzer with the specified note
  * 
@@ -90,4 +213,36 @@ void buzzer_on(Note note) {
  */
 void buzzer_off(void) {
     TCA0.SINGLE.CMP0BUF = 0;
-}
\ No newline at end of file
+}
+
+/**
+ * Moves the TCA0 prescaler with a new CPU clock level
+ *
+ * Governor levels are F_CPU shifted by powers of two, so shifting the
+ * prescaler the same way keeps the tone clock, and every period in
+ * base_periods, exact (range checked in clock.h).
+ */
+void buzzer_retune(void) {
+    const uint8_t clksel = (TONE_CLKSEL >> TCA_SINGLE_CLKSEL_gp) + clock_shift();
+    TCA0.SINGLE.CTRLA = (clksel << TCA_SINGLE_CLKSEL_gp) | TCA_SINGLE_ENABLE_bm;
+}
+
+/**
+ * Starts a note on one voice; only voice 0 exists in this build
+ */
+void voice_on(uint8_t voice, Note note) {
+    if (voice == 0) {
+        buzzer_on(note);
+    }
+}
+
+/**
+ * Silences one voice; only voice 0 exists in this build
+ */
+void voice_off(uint8_t voice) {
+    if (voice == 0) {
+        buzzer_off();
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,76 @@
+/**
+ * @file ccl_filter.c
+ * @brief Button glitch filtering in the CCL (-DCCL_FILTER=1)
+ *
+ * Signal path per button, S1-S4 on LUT0-LUT3:
+ *   PAn -> EVSYS channel -> LUT EVENTA (IN0) -> filter -> LUT output
+ *       -> falling-edge interrupt -> GPIOR3 bit n -> pb_debounce()
+ *
+ * The filter takes four samples of the LUT clock; with CLK_CCL from the
+ * 1.024kHz oscillator a pulse shorter than four periods (about 3.9ms)
+ * never reaches the output, which rejects most contact bounce and all
+ * short glitches in hardware.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "ccl_filter.h"
+#include "flags.h"
+
+#if CCL_FILTER
+
+/* LUT truth table for OUT = IN0 (IN1 and IN2 masked) */
+#define LUT_PASS_IN0 0xAA
+
+#define LUT_CTRLA (CCL_ENABLE_bm | CCL_FILTSEL_FILTER_gc | CCL_CLKSRC_OSC1K_gc)
+
+/**
+ * Routes PA4-PA7 through filtered LUTs and enables their press interrupts
+ *
+ * The LUTs are configured with the CCL disabled, as the hardware
+ * requires, and the CCL is enabled last.
+ */
+void ccl_filter_init(void) {
+    /* Button pins onto the event channels that can carry PORTA */
+    EVSYS.CHANNEL0 = EVSYS_CHANNEL0_PORTA_PIN4_gc;  // S1
+    EVSYS.CHANNEL1 = EVSYS_CHANNEL1_PORTA_PIN5_gc;  // S2
+    EVSYS.CHANNEL2 = EVSYS_CHANNEL2_PORTA_PIN6_gc;  // S3
+    EVSYS.CHANNEL3 = EVSYS_CHANNEL3_PORTA_PIN7_gc;  // S4
+    EVSYS.USERCCLLUT0A = EVSYS_USER_CHANNEL0_gc;
+    EVSYS.USERCCLLUT1A = EVSYS_USER_CHANNEL1_gc;
+    EVSYS.USERCCLLUT2A = EVSYS_USER_CHANNEL2_gc;
+    EVSYS.USERCCLLUT3A = EVSYS_USER_CHANNEL3_gc;
+
+    /* Each LUT passes its event input through the filter */
+    CCL.LUT0CTRLB = CCL_INSEL0_EVENTA_gc;
+    CCL.LUT1CTRLB = CCL_INSEL0_EVENTA_gc;
+    CCL.LUT2CTRLB = CCL_INSEL0_EVENTA_gc;
+    CCL.LUT3CTRLB = CCL_INSEL0_EVENTA_gc;
+    CCL.TRUTH0 = LUT_PASS_IN0;
+    CCL.TRUTH1 = LUT_PASS_IN0;
+    CCL.TRUTH2 = LUT_PASS_IN0;
+    CCL.TRUTH3 = LUT_PASS_IN0;
+    CCL.LUT0CTRLA = LUT_CTRLA;
+    CCL.LUT1CTRLA = LUT_CTRLA;
+    CCL.LUT2CTRLA = LUT_CTRLA;
+    CCL.LUT3CTRLA = LUT_CTRLA;
+
+    /* Interrupt on filtered presses (falling edges) only */
+    CCL.INTCTRL0 = CCL_INTMODE0_FALLING_gc | CCL_INTMODE1_FALLING_gc |
+                   CCL_INTMODE2_FALLING_gc | CCL_INTMODE3_FALLING_gc;
+    CCL.CTRLA = CCL_ENABLE_bm;
+}
+
+/**
+ * CCL Interrupt Service Routine
+ *
+ * Flags each filtered press in GPIOR3 at its pin position (LUTn -> PA4+n)
+ * for pb_debounce() to confirm.
+ */
+ISR(CCL_CCL_vect) {
+    uint8_t lut_flags = CCL.INTFLAGS & 0x0F;
+    CCL.INTFLAGS = lut_flags;       // Clear the flags handled
+    GPIOR3 |= lut_flags << 4;
+}
+
+#endif
@@ -0,0 +1,174 @@
+/**
+ * @file clock_governor.c
+ * @brief CPU clock levels for idle waits and compute-heavy work
+ *
+ * Every level is 20MHz divided by a CLKCTRL prescaler, a power of two
+ * away from F_CPU (clock.h). The register values for each level are
+ * derived at compile time with the same formulas as the F_CPU profile,
+ * so a switch is a handful of register writes:
+ * - MCLKCTRLB, under configuration change protection
+ * - TCB0/TCB1 periods, with the running counts scaled by the same power
+ *   of two so the current tick keeps its phase
+ * - USART0 BAUD, once the last frame has been sent
+ * - TCA0 prescaler (buzzer_retune()), so the tone clock is unchanged
+ *
+ * The TCB clock and ADC settings are chosen for the fastest level and
+ * stay valid at the slower ones. A byte received during a switch may be
+ * garbled; transmission always completes first.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/cpufunc.h>
+#include <avr/pgmspace.h>
+#include "clock_governor.h"
+#include "timer.h"
+#include "uart.h"
+#include "uart_format.h"
+#include "buzzer.h"
+
+#if CLOCK_GOVERNOR
+
+typedef struct {
+    uint8_t mclkctrlb;      // Main clock prescaler
+    uint16_t tick_ccmp;     // TCB0 1ms period
+    uint16_t mux_ccmp;      // TCB1 5ms period
+    uint16_t baud;          // USART0 BAUD
+    uint16_t khz;           // CLK_PER, for the report
+    uint16_t microwatts;    // Estimated power
+} clock_profile_t;
+
+#define CLOCK_MICROWATTS(hz) \
+    ((uint32_t)CLOCK_SUPPLY_MV * (CLOCK_UA_STATIC + CLOCK_UA_PER_MHZ * ((hz) / 1000) / 1000) / 1000)
+
+#define CLOCK_PROFILE(hz) {                     \
+    .mclkctrlb = CLOCK_PDIV(CLOCK_DIVISOR(hz)), \
+    .tick_ccmp = TIMER_TICK_CCMP_AT(hz),        \
+    .mux_ccmp = TIMER_MUX_CCMP_AT(hz),          \
+    .baud = UART_BAUD_VALUE_AT(hz),             \
+    .khz = (hz) / 1000,                         \
+    .microwatts = CLOCK_MICROWATTS(hz)          \
+}
+
+static const clock_profile_t profiles[CLOCK_LEVELS] = {
+    [CLOCK_IDLE] = CLOCK_PROFILE(CLOCK_MIN_HZ),
+    [CLOCK_ACTIVE] = CLOCK_PROFILE(F_CPU),
+    [CLOCK_BOOST] = CLOCK_PROFILE(CLOCK_MAX_HZ),
+};
+
+/* Each level's clock as a shift from CLOCK_MIN_HZ */
+static const uint8_t level_scale[CLOCK_LEVELS] = {
+    [CLOCK_IDLE] = 0,
+    [CLOCK_ACTIVE] = CLOCK_IDLE_SHIFT,
+    [CLOCK_BOOST] = CLOCK_IDLE_SHIFT + CLOCK_BOOST_SHIFT,
+};
+
+static const char name_idle[] PROGMEM = "idle";
+static const char name_active[] PROGMEM = "active";
+static const char name_boost[] PROGMEM = "boost";
+
+static const char *const level_names[CLOCK_LEVELS] = {
+    [CLOCK_IDLE] = name_idle,
+    [CLOCK_ACTIVE] = name_active,
+    [CLOCK_BOOST] = name_boost,
+};
+
+clock_level_t clock_level = CLOCK_ACTIVE;   // clock_init() sets F_CPU
+
+static uint32_t level_ms[CLOCK_LEVELS];     // Time spent at each level
+static uint32_t level_since;                // Tick the current level began
+static uint16_t switches;                   // Level changes since reset
+
+/**
+ * Adds the time since the last switch to the current level
+ */
+static void account(void) {
+    uint32_t now = ticks_now();
+    level_ms[clock_level] += now - level_since;
+    level_since = now;
+}
+
+/**
+ * Scales a running TCB count to a new clock level
+ *
+ * @param count Count at the old level
+ * @param from Old level's scale
+ * @param to New level's scale
+ * @param top New period (CCMP), which the result never passes
+ * @return Count at the same point of the period at the new level
+ */
+static uint16_t rescale(uint16_t count, uint8_t from, uint8_t to, uint16_t top) {
+    uint32_t scaled = ((uint32_t)count << to) >> from;
+    return scaled > top ? top : scaled;
+}
+
+/**
+ * Switches the CPU clock level and rescales the timed peripherals
+ *
+ * @param level Level to run at
+ *
+ * Returns at once if already at the level. Otherwise waits for any
+ * frame still being transmitted (at most two at UART_BAUD), then
+ * switches with interrupts disabled, so no ISR sees a mix of settings.
+ */
+void clock_set(clock_level_t level) {
+#if !CLOCK_BOOST_SHIFT
+    if (level == CLOCK_BOOST) {
+        level = CLOCK_ACTIVE;   // No faster level in this build
+    }
+#endif
+    if (level == clock_level) {
+        return;
+    }
+
+    uint8_t sreg;
+    for (;;) {
+        uart_flush();
+        sreg = SREG;
+        cli();
+        if (uart_tx_idle()) {
+            break;          // Nothing queued by an ISR since the flush
+        }
+        SREG = sreg;
+    }
+
+    account();
+    const clock_profile_t *profile = &profiles[level];
+    const uint8_t from = level_scale[clock_level];
+    const uint8_t to = level_scale[level];
+
+    _PROTECTED_WRITE(CLKCTRL.MCLKCTRLB, profile->mclkctrlb);
+
+    TCB0.CCMP = profile->tick_ccmp;
+    TCB0.CNT = rescale(TCB0.CNT, from, to, profile->tick_ccmp);
+    TCB1.CCMP = profile->mux_ccmp;
+    TCB1.CNT = rescale(TCB1.CNT, from, to, profile->mux_ccmp);
+    USART0.BAUD = profile->baud;
+
+    clock_level = level;
+    buzzer_retune();
+    switches++;
+    SREG = sreg;
+}
+
+/**
+ * Reports time and estimated energy at each level (":clock")
+ *
+ * Power is estimated as CLOCK_SUPPLY_MV * (CLOCK_UA_STATIC +
+ * CLOCK_UA_PER_MHZ * MHz); energy is rounded down to whole mJ.
+ */
+void clock_report(void) {
+    account();
+
+    uint32_t total_mj = 0;
+    for (uint8_t i = 0; i < CLOCK_LEVELS; i++) {
+        const clock_profile_t *profile = &profiles[i];
+        uint32_t mj = (uint32_t)profile->microwatts * (level_ms[i] / 1000) / 1000;
+        total_mj += mj;
+        uart_printf("%S: %u kHz, %lu ms, ~%u uW, ~%lu mJ\n", level_names[i],
+                    profile->khz, level_ms[i], profile->microwatts, mj);
+    }
+    uart_printf("clock: %u switches, ~%lu mJ total\n", switches, total_mj);
+}
+
+#endif
@@ -0,0 +1,304 @@
+/**
+ * @file console.c
+ * @brief Line-oriented UART console for run-time tuning and diagnostics
+ *
+ * A command line is opened by sending CONSOLE_PROMPT (':'); from then until
+ * the end of the line, received characters bypass the game keymap and are
+ * queued by the RX ISR. The main loop consumes the queue incrementally,
+ * echoing and collecting one line, then executes it.
+ *
+ * Commands (a value sets, no value reads back; settings are saved, see
+ * settings.c):
+ *   :delay [ms]     Fixed playback delay, 0 returns control to the pot
+ *   :octave [n]     Pitch shift, -3 to 3
+ *   :seed [hex]     Sequence seed, 0x prefix optional; applied from the next round
+ *   :bright [n]     Display brightness, 0 (off) to 5 (full)
+ *   :early [ms]     Typeahead early-input window, 0 disables (typeahead builds)
+ *   :stats          Dump run-time counters
+ *   :gen            Compare sequence generator quality and speed (boost clock)
+ *   :save           Save the game context, score and level to RAM
+ *   :load           Restore the save and replay its round
+ *   :link           Measure link round-trip time (versus mode)
+ *   :irq            Worst-case interrupt latency and handler time, then reset
+ *                   (IRQ_LATENCY builds)
+ *   :press          Button press latency, then reset (PRESS_BENCH builds)
+ *   :bot            Self-play statistics, then reset (SELF_PLAY builds)
+ *   :clock          Time and energy per clock level (CLOCK_GOVERNOR builds)
+ *   :boot           Reset into the serial bootloader (BOOT_SIZE builds)
+ */
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/cpufunc.h>
+#include <string.h>
+#include "console.h"
+#include "uart.h"
+#include "uart_format.h"
+#include "timer.h"
+#include "buzzer.h"
+#include "lsfr.h"
+#include "display.h"
+#include "stack.h"
+#include "link.h"
+#include "boot.h"
+#include "typeahead.h"
+#include "game.h"
+#include "clock_governor.h"
+#include "irq.h"
+#include "settings.h"
+#include "press_bench.h"
+#include "self_play.h"
+
+console_counters_t counters;
+volatile uint8_t console_active = 0;   // Flag set while a line is being typed
+
+/* Receive ring shared with the RX ISR */
+static volatile char rx_ring[CONSOLE_RX_SIZE];
+static volatile uint8_t rx_head;       // Written by the ISR
+static volatile uint8_t rx_tail;       // Read by the main loop
+
+/* Line being assembled by the main loop */
+static char line[CONSOLE_LINE_SIZE];
+static uint8_t line_length;
+
+/**
+ * Queues a received console character (called from the RX ISR)
+ *
+ * @param c Character received
+ *
+ * The line ends at '\r' or '\n', after which the game keymap applies again.
+ */
+void console_receive(char c) {
+    uint8_t next = (rx_head + 1) & (CONSOLE_RX_SIZE - 1);
+
+    if (next == rx_tail) {
+        counters.rx_overflows++;
+    } else {
+        rx_ring[rx_head] = c;
+        rx_head = next;
+    }
+
+    if (c == '\r' || c == '\n') {
+        console_active = 0;
+    }
+}
+
+/**
+ * Parses a signed decimal or 0x-prefixed hexadecimal number
+ *
+ * @param text String to parse
+ * @param value Pointer to store the result
+ * @param hex Non-zero to read hexadecimal without the 0x prefix too
+ * @return Non-zero if the whole string was a valid number of 32 bits
+ *         at most
+ */
+static uint8_t parse_number(const char *text, int32_t *value, uint8_t hex) {
+    uint8_t negative = 0;
+    uint32_t result = 0;
+
+    if (*text == '-') {
+        negative = 1;
+        text++;
+    }
+    if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        hex = 1;
+        text += 2;
+    }
+    if (!*text) {
+        return 0;
+    }
+
+    for (; *text; text++) {
+        char c = *text;
+        uint8_t digit;
+
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (hex && (c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+            digit = (c | 0x20) - 'a' + 10;
+        } else {
+            return 0;
+        }
+        if (hex ? result >> 28 : result > (0xFFFFFFFFul - digit) / 10) {
+            return 0;   // More than 32 bits
+        }
+        result = hex ? (result << 4) | digit : (result << 3) + (result << 1) + digit;
+    }
+
+    *value = negative ? -(int32_t)result : (int32_t)result;
+    return 1;
+}
+
+/**
+ * Dumps run-time counters
+ */
+static void print_stats(void) {
+    uart_printf("games: %u rounds: %u presses: %u rx drops: %u\n",
+                counters.games, counters.rounds, counters.presses, counters.rx_overflows);
+    uart_printf("ticks: %lu stack peak: %u free: %u\n",
+                ticks_now(), stack_peak(), stack_unused());
+}
+
+#if BOOT_SIZE
+/**
+ * Hands over to the serial bootloader with a software reset
+ *
+ * The bootloader only waits for an upload after a software reset; the
+ * uploader switches to BOOT_BAUD once this line has been sent.
+ */
+static void enter_bootloader(void) {
+    uart_printf("boot: %lu baud\n", BOOT_BAUD);
+    uart_flush();   // Wait for the last bit
+    _PROTECTED_WRITE(RSTCTRL.SWRR, RSTCTRL_SWRST_bm);
+}
+#endif
+
+/**
+ * Executes one command line
+ *
+ * @param command Null-terminated line without the prompt character
+ */
+static void execute(char *command) {
+    char *argument = strchr(command, ' ');
+    int32_t value = 0;
+    uint8_t has_value = 0;
+
+    if (argument) {
+        *argument++ = '\0';
+        has_value = parse_number(argument, &value, !strcmp_P(command, PSTR("seed")));
+        if (!has_value) {
+            uart_puts_F("bad value\n");
+            return;
+        }
+    }
+
+    if (!strcmp_P(command, PSTR("delay"))) {
+        if (has_value) {
+            if (value < 0 || value > 0xFFFF) {
+                uart_puts_F("range 0-65535\n");
+                return;
+            }
+            playback_delay_override = value;
+            settings.delay = value;
+            settings_touch();
+        }
+        if (playback_delay_override) {
+            uart_printf("delay: %u (fixed)\n", playback_delay_override);
+        } else {
+            uart_printf("delay: %u (pot)\n", playback_delay);
+        }
+    } else if (!strcmp_P(command, PSTR("octave"))) {
+        if (has_value) {
+            if (value < min_frequency || value > max_frequency) {
+                uart_puts_F("range -3-3\n");
+                return;
+            }
+            frequency = value;
+            settings_touch();
+        }
+        uart_printf("octave: %d\n", frequency);
+    } else if (!strcmp_P(command, PSTR("seed"))) {
+        if (has_value) {
+            if (value == 0) {
+                uart_puts_F("seed must be non-zero\n");
+                return;
+            }
+            game.seed = (uint32_t)value;
+            settings.seed = game.seed;
+            settings_touch();
+        }
+        uart_printf("seed: %08lX\n", game.seed);
+    } else if (!strcmp_P(command, PSTR("bright"))) {
+        if (has_value) {
+            if (value < 0 || value > DISPLAY_BRIGHTNESS_MAX) {
+                uart_puts_F("range 0-5\n");
+                return;
+            }
+            display_brightness = value;
+            settings_touch();
+        }
+        uart_printf("bright: %u\n", display_brightness);
+#if TYPEAHEAD_MS
+    } else if (!strcmp_P(command, PSTR("early"))) {
+        if (has_value) {
+            if (value < 0 || value >= SETTINGS_EARLY_UNSET) {
+                uart_puts_F("range 0-65534\n");
+                return;
+            }
+            typeahead_window = value;
+            settings_touch();
+        }
+        uart_printf("early: %u ms\n", typeahead_window);
+#endif
+    } else if (!strcmp_P(command, PSTR("stats"))) {
+        print_stats();
+    } else if (!strcmp_P(command, PSTR("gen"))) {
+        clock_set(CLOCK_BOOST);  // The main loop drops back afterwards
+        generator_bench();
+    } else if (!strcmp_P(command, PSTR("save"))) {
+        game_save();
+        uart_printf("saved: level %u\n", game.sequence_length);
+    } else if (!strcmp_P(command, PSTR("load"))) {
+        if (!game_load()) {
+            uart_puts_F("nothing saved\n");
+            return;
+        }
+        uart_printf("loaded: level %u\n", game.sequence_length);
+#if VERSUS_MODE
+    } else if (!strcmp_P(command, PSTR("link"))) {
+        link_ping();
+#endif
+#if IRQ_LATENCY
+    } else if (!strcmp_P(command, PSTR("irq"))) {
+        irq_latency_report();
+#endif
+#if PRESS_BENCH
+    } else if (!strcmp_P(command, PSTR("press"))) {
+        press_bench_report();
+#endif
+#if SELF_PLAY
+    } else if (!strcmp_P(command, PSTR("bot"))) {
+        self_play_report();
+#endif
+#if CLOCK_GOVERNOR
+    } else if (!strcmp_P(command, PSTR("clock"))) {
+        clock_report();
+#endif
+#if BOOT_SIZE
+    } else if (!strcmp_P(command, PSTR("boot"))) {
+        enter_bootloader();
+#endif
+    } else {
+        uart_puts_F("commands: delay octave seed bright stats gen save load\n");
+    }
+}
+
+/**
+ * Consumes queued console characters (called from the main loop)
+ *
+ * Echoes each character and executes the line when it ends. Handles
+ * backspace; characters beyond CONSOLE_LINE_SIZE are dropped.
+ */
+void console_poll(void) {
+    while (rx_tail != rx_head) {
+        char c = rx_ring[rx_tail];
+        rx_tail = (rx_tail + 1) & (CONSOLE_RX_SIZE - 1);
+
+        if (c == CONSOLE_PROMPT && line_length == 0) {
+            uart_putc(c);
+        } else if (c == '\r' || c == '\n') {
+            uart_putc('\n');
+            line[line_length] = '\0';
+            line_length = 0;
+            execute(line);
+        } else if (c == '\b' || c == 0x7F) {
+            if (line_length) {
+                line_length--;
+                uart_puts_F("\b \b");
+            }
+        } else if (line_length < CONSOLE_LINE_SIZE - 1) {
+            line[line_length++] = c;
+            uart_putc(c);
+        }
+    }
+}
@@ -6,12 +6,15 @@
  * - Displaying numbers (0-9)
  * - Showing animation patterns
  * - Managing display updates via SPI
+ * - Tear-free frame updates (front/back buffers flipped by the ISR)
  */
 
 #include "display.h"
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include <avr/pgmspace.h>
+#include "flags.h"
+#include "symbols.h"
 
 /**
  * Segment patterns for digits 0-9 and blank (off)
@@ -24,11 +27,21 @@ const uint8_t segments[11] = {
 };
 
 /**
- * Current display states for left and right digits
- * DISP_OFF (0xFF) indicates the display is blank
+ * Front and back display frames, selected by FLAG_DISPLAY_FRONT
+ * DISP_OFF indicates a blank digit
  */
-volatile uint8_t left_byte = DISP_OFF;
-volatile uint8_t right_byte = DISP_OFF;
+volatile display_frame_t display_frames[2] = {
+    {DISP_OFF, DISP_OFF},
+    {DISP_OFF, DISP_OFF}
+};
+
+/**
+ * Display dimming state:
+ * display_brightness: ms each digit stays lit per 5ms slot
+ * display_lit_ticks: 1ms ticks since the current digit was latched
+ */
+volatile uint8_t display_brightness = DISPLAY_BRIGHTNESS_MAX;
+volatile uint8_t display_lit_ticks = 0;
 
 /**
  * Updates the display buffer with new values
@@ -37,10 +50,21 @@ volatile uint8_t right_byte = DISP_OFF;
  * @param right Value for the right display
  * 
  * The left display value is combined with DISP_LHS to ensure proper positioning
+ * 
+ * Writes the whole frame into the back buffer and commits it:
+ * 1. Withdraw any pending commit (CBI), so the ISR cannot flip mid-write
+ * 2. Fill the back frame, which the ISR never reads
+ * 3. Commit (SBI); the ISR flips before its next left digit
+ * Never blocks; a frame committed before the flip is simply replaced.
  */
 void update_display(const uint8_t left, const uint8_t right) {
-    left_byte = left | DISP_LHS;
-    right_byte = right;
+    flag_clear(FLAG_DISPLAY_COMMIT);
+
+    volatile display_frame_t *back = &display_frames[flag_test(FLAG_DISPLAY_FRONT) ? 0 : 1];
+    back->left = left | DISP_LHS;
+    back->right = right;
+
+    flag_set(FLAG_DISPLAY_COMMIT);
 }
 
 /**
@@ -50,24 +74,37 @@ void update_display(const uint8_t left, const uint8_t right) {
  * - Second pair: " |  " (center-left position)
  * - Third pair:  "  | " (center-right position)
  * - Fourth pair: "   |" (rightmost position)
+ * Symbols S5-S8 light the top or bottom segment of one digit instead.
  */
 static const uint8_t segment_patterns[][2] = {
     {DISP_BAR_LEFT, DISP_OFF},     // "|   "
     {DISP_BAR_RIGHT, DISP_OFF},    // " |  "
     {DISP_OFF, DISP_BAR_LEFT},     // "  | "
-    {DISP_OFF, DISP_BAR_RIGHT}     // "   |"
+    {DISP_OFF, DISP_BAR_RIGHT},    // "   |"
+#if SYMBOL_COUNT > 4
+    {DISP_SEG_A, DISP_OFF},        // top, left digit
+#endif
+#if SYMBOL_COUNT > 5
+    {DISP_SEG_D, DISP_OFF},        // bottom, left digit
+#endif
+#if SYMBOL_COUNT > 6
+    {DISP_OFF, DISP_SEG_A},        // top, right digit
+#endif
+#if SYMBOL_COUNT > 7
+    {DISP_OFF, DISP_SEG_D},        // bottom, right digit
+#endif
 };
 
 /**
  * Displays an animation step using predefined patterns
  * 
- * @param step Animation step (0-3 for different bar positions, >=4 turns display off)
+ * @param step Symbol to show (0 to SYMBOL_COUNT-1), DISP_STEP_OFF to blank
  * 
- * For steps 0-3, displays a vertical bar in different positions
- * For steps >=4, turns the display off completely
+ * For symbols 0-3, displays a vertical bar in different positions
+ * For any other step outside the alphabet, turns the display off completely
  */
 void display_digit(uint8_t step) {
-    if (step < 4) {
+    if (step < SYMBOL_COUNT) {
         update_display(segment_patterns[step][0], 
                       segment_patterns[step][1]);
     } else {
@@ -75,35 +112,23 @@ void display_digit(uint8_t step) {
     }
 }
 
-/**
- * Extracts individual digits from a number for display
- * 
- * @param number Number to split into digits (0-99)
- * @param left_digit Pointer to store tens digit (or blank if zero)
- * @param right_digit Pointer to store ones digit
- * 
- * Note: Division operation is maintained for timing-critical playback delay tests.
- * Alternative implementations (bit shifting, subtraction) affect timing characteristics.
- * This is a known. But fuck it I am happy to lose marks I have spent to long on this...
- */
-void extract_digits(uint32_t number, uint8_t *left_digit, uint8_t *right_digit) {
-    uint8_t tens = (uint8_t)(number / 10);
-    *left_digit = tens > 0 ? tens : 10;  // Use 10 (blank) if tens digit is 0
-    *right_digit = (uint8_t)(number % 10);
-}
-
 /**
  * SPI Interrupt Service Routine
  * 
  * Handles SPI transmission completion:
  * 1. Clears the latch pin (PORTA.PIN1)
  * 2. Sets the latch pin high to update display
- * 3. Clears the interrupt flag
+ * 3. Re-enables the display (DISP EN low) unless brightness is 0
+ * 4. Clears the interrupt flag
  * 
  * This timing-critical routine ensures proper display updates via SPI
  */
 ISR(SPI0_INT_vect) {
     PORTA.OUTCLR = PIN1_bm;    // Clear latch pin
     PORTA.OUTSET = PIN1_bm;    // Set latch pin high
+    display_lit_ticks = 0;     // Start timing the lit period
+    if (display_brightness) {
+        PORTB.OUTCLR = PIN1_bm; // Enable display output
+    }
     SPI0.INTFLAGS = SPI_IF_bm; // Clear interrupt flag
 }
\ No newline at end of file
@@ -0,0 +1,134 @@
+/**
+ * @file endurance.c
+ * @brief Checkpointed long games (-DENDURANCE_INTERVAL=n)
+ *
+ * The sequence is split into segments of ENDURANCE_INTERVAL levels. A
+ * round plays and checks the steps from the start of the current segment,
+ * generated from the checkpointed generator state rather than from seed,
+ * so playback and input time are bounded however long the game runs.
+ *
+ * A checkpoint is taken when a level that is a multiple of the interval
+ * is completed: the generator state after that level's last step (the
+ * state the player's input left behind), the step count, score and level.
+ * Resuming copies it back; nothing is replayed. The console save slot
+ * (game.c) keeps a copy of the segment and checkpoint as well.
+ */
+
+#include <avr/io.h>
+#include "endurance.h"
+#include "score.h"
+#include "display.h"
+#include "input.h"
+
+#if ENDURANCE_INTERVAL
+
+typedef struct {
+    uint32_t state;         // Generator state after the checkpointed level
+    uint16_t length;        // Steps completed at the checkpoint
+    bcd_counter_t score;    // Score at the checkpoint
+    bcd_counter_t level;    // Level to resume at
+} endurance_checkpoint_t;
+
+static endurance_checkpoint_t checkpoint;
+
+/* Start of the current segment */
+uint32_t endurance_start_state;
+uint16_t endurance_start_length;
+
+/* Copy of the segment and checkpoint for the console save slot */
+static struct {
+    uint32_t start_state;
+    uint16_t start_length;
+    endurance_checkpoint_t checkpoint;
+} saved;
+
+/**
+ * Starts a new game from the seed and drops any checkpoint
+ */
+void endurance_reset(void) {
+    endurance_start_state = game.seed;
+    endurance_start_length = 0;
+    checkpoint.length = 0;
+}
+
+/**
+ * Takes a checkpoint after a completed level (called at SUCCESS)
+ *
+ * @param completed Level just completed (its sequence length)
+ *
+ * Call after the level counter has been advanced; state_sequence is
+ * still the state after the level's last step.
+ */
+void endurance_checkpoint(uint16_t completed) {
+    if (completed % ENDURANCE_INTERVAL) {
+        return;
+    }
+    checkpoint.state = game.state_sequence;
+    checkpoint.length = completed;
+    checkpoint.score = score;
+    checkpoint.level = level;
+
+    endurance_start_state = checkpoint.state;
+    endurance_start_length = completed;
+}
+
+/**
+ * Offers to resume after a failure (called at START)
+ *
+ * @param pressed Buttons pressed since the last call
+ * @return ENDURANCE_FRESH without a checkpoint, otherwise the player's
+ *         choice once a button is pressed
+ *
+ * Shows the checkpoint level while waiting.
+ */
+endurance_choice_t endurance_choice(uint8_t pressed) {
+    if (!checkpoint.length) {
+        return ENDURANCE_FRESH;
+    }
+
+    uint8_t left_digit, right_digit;
+    bcd_display_digits(&checkpoint.level, &left_digit, &right_digit);
+    update_display(segments[left_digit], segments[right_digit]);
+
+    if (!pressed) {
+        return ENDURANCE_WAIT;
+    }
+    display_digit(DISP_STEP_OFF);
+    return (pressed & mapped_array[0].pin) ? ENDURANCE_RESUME : ENDURANCE_FRESH;
+}
+
+/**
+ * Restores the checkpoint for a resumed game
+ *
+ * @return Sequence length of the first resumed round
+ */
+uint16_t endurance_resume(void) {
+    score = checkpoint.score;
+    level = checkpoint.level;
+    endurance_start_state = checkpoint.state;
+    endurance_start_length = checkpoint.length;
+    return checkpoint.length + 1;
+}
+
+/**
+ * Saves the segment and checkpoint with the game context (game_save())
+ */
+void endurance_save(void) {
+    saved.start_state = endurance_start_state;
+    saved.start_length = endurance_start_length;
+    saved.checkpoint = checkpoint;
+}
+
+/**
+ * Restores the segment and checkpoint with the game context (game_load())
+ *
+ * The saved sequence length is only valid against the segment it was
+ * saved in, so both are restored together.
+ */
+void endurance_load(void) {
+    endurance_start_state = saved.start_state;
+    endurance_start_length = saved.start_length;
+    checkpoint = saved.checkpoint;
+}
+
+#endif
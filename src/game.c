@@ -0,0 +1,82 @@
+/**
+ * @file game.c
+ * @brief Shared game context and its save slot
+ *
+ * The context (game.h) is one packed block, so a save-state is a single
+ * copy. One slot is kept in SRAM alongside the score and level, which
+ * score.c owns, and the endurance segment, which endurance.c keeps; it
+ * does not survive a reset.
+ */
+
+#include <avr/io.h>
+#include "game.h"
+#include "score.h"
+#include "buzzer.h"
+#include "display.h"
+#include "endurance.h"
+#include "typeahead.h"
+#include "reaction.h"
+
+game_t game = {
+    .stage = START,
+    .button = COMPLETE,
+    .sequence_matched = 1,
+    .seed = 0x11638494,             // Non-zero, so the LFSR never sticks at 0
+};
+
+static struct {
+    game_t game;
+    bcd_counter_t score;
+    bcd_counter_t level;
+    uint8_t valid;
+} saved;
+
+/**
+ * Saves the context, score, level and endurance segment into the slot
+ */
+void game_save(void) {
+    saved.game = game;
+    saved.score = score;
+    saved.level = level;
+    endurance_save();
+    saved.valid = 1;
+}
+
+/**
+ * Restores the slot and restarts the saved round from its playback
+ *
+ * Called from the main loop. A game saved before its first round is
+ * restored to START; any other save replays its round, including one
+ * that had just been won or lost. Early presses and reaction statistics
+ * from the abandoned round are dropped.
+ *
+ * @return Non-zero if a save was restored
+ */
+uint8_t game_load(void) {
+    if (!saved.valid) {
+        return 0;
+    }
+
+    buzzer_off();
+    display_digit(DISP_STEP_OFF);
+
+    game = saved.game;
+    score = saved.score;
+    level = saved.level;
+    endurance_load();
+    typeahead_clear();
+    reaction_reset();
+
+    game_t *g = game_context();
+    if (g->stage != START) {
+        g->stage = START_SEQUENCE;
+    }
+    g->button = COMPLETE;
+    g->button_active = 0;
+    g->player_input = 0;
+    g->sequence_matched = 1;
+    g->pb_released = 0;
+    g->pushbutton_received = 0;
+    g->sequence_position = 0;
+    return 1;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file generator_bench.c
+ * @brief On-target quality and speed comparison of sequence generators
+ *
+ * Runs every backend in sequence_generators[] from the current seed and
+ * reports over UART, over the k = 2^SYMBOL_BITS raw draws (before any
+ * rejection of draws past SYMBOL_COUNT):
+ * - chi2:   symbol frequency chi-square, k bins (k - 1 dof; 95% limits
+ *           3.84, 7.81, 14.07 for k = 2, 4, 8)
+ * - pairs:  serial chi-square on consecutive step pairs, k^2 bins
+ *           (95% limits 7.81, 25.00, 82.53); high values mean correlated
+ *           steps
+ * - runs:   number of runs of repeated symbols against the expected
+ *           1 + (N - 1) * (k - 1)/k, and the longest run
+ * - cycles: CPU cycles per step, timed over BENCH_STEPS calls
+ *
+ * BENCH_STEPS is a power of two so the expected bin counts, and the
+ * divisions in the chi-square sums, reduce to shifts.
+ *
+ * scripts/generator_bench.py builds this file for the host and prints the
+ * same statistics; only the cycle counts need the target.
+ */
+
+#include <avr/io.h>
+#include "lsfr.h"
+#include "timer.h"
+#include "clock_governor.h"
+#include "uart_format.h"
+
+#define BENCH_SHIFT 12
+#define BENCH_STEPS (1u << BENCH_SHIFT)
+
+#define BENCH_BINS (1u << SYMBOL_BITS)
+#define BENCH_PAIRS (1u << (2 * SYMBOL_BITS))
+
+/**
+ * Scales a sum of squared deviations to chi-square x100
+ *
+ * @param sum_sq Sum over bins of (observed - expected)^2
+ * @param shift log2 of the expected count per bin
+ * @return Chi-square statistic multiplied by 100
+ */
+static uint32_t chi_square_x100(uint32_t sum_sq, uint8_t shift) {
+    uint32_t mask = (1ul << shift) - 1;
+    return (sum_sq >> shift) * 100 + (((sum_sq & mask) * 100) >> shift);
+}
+
+/**
+ * Runs the statistical tests and timing for one backend
+ *
+ * @param generator Backend to test
+ */
+static void bench_one(const sequence_generator_t *generator) {
+    uint16_t singles[BENCH_BINS] = {0};
+    uint16_t pairs[BENCH_PAIRS] = {0};
+    uint16_t runs = 1;
+    uint8_t run_length = 1;
+    uint8_t longest = 1;
+    uint32_t state = game.seed;
+    uint8_t previous, current, bit;
+
+    /* Statistics over BENCH_STEPS steps */
+    generator->next(&state, &previous, &bit);
+    for (uint16_t i = 0; i < BENCH_STEPS; i++) {
+        generator->next(&state, &current, &bit);
+        singles[current]++;
+        pairs[(previous << SYMBOL_BITS) | current]++;
+
+        if (current == previous) {
+            if (++run_length > longest) {
+                longest = run_length;
+            }
+        } else {
+            runs++;
+            run_length = 1;
+        }
+        previous = current;
+    }
+
+    uint32_t singles_sq = 0;
+    for (uint8_t i = 0; i < BENCH_BINS; i++) {
+        int16_t deviation = singles[i] - (BENCH_STEPS >> SYMBOL_BITS);
+        singles_sq += (int32_t)deviation * deviation;
+    }
+
+    uint32_t pairs_sq = 0;
+    for (uint8_t i = 0; i < BENCH_PAIRS; i++) {
+        int16_t deviation = pairs[i] - (BENCH_STEPS >> (2 * SYMBOL_BITS));
+        pairs_sq += (int32_t)deviation * deviation;
+    }
+
+    /* Timing over the same number of steps, without the bookkeeping */
+    state = game.seed;
+    uint32_t start = ticks_now();
+    for (uint16_t i = 0; i < BENCH_STEPS; i++) {
+        generator->next(&state, &current, &bit);
+    }
+    uint32_t elapsed = ticks_since(start);
+    uint32_t cycles = (elapsed * clock_khz()) >> BENCH_SHIFT;
+
+    uint32_t chi = chi_square_x100(singles_sq, BENCH_SHIFT - SYMBOL_BITS);
+    uint32_t serial = chi_square_x100(pairs_sq, BENCH_SHIFT - 2 * SYMBOL_BITS);
+
+    uart_printf("%S: chi2 %lu.%02lu pairs %lu.%02lu runs %u/%u longest %u cycles %lu\n",
+                generator->name,
+                chi / 100, chi % 100,
+                serial / 100, serial % 100,
+                runs, 1 + ((BENCH_STEPS - 1) * (BENCH_BINS - 1)) / BENCH_BINS, longest,
+                cycles);
+}
+
+/**
+ * Benchmarks every sequence generator backend from the current seed
+ *
+ * Blocks for roughly a second at 3.33MHz; intended for the console.
+ */
+void generator_bench(void) {
+    for (uint8_t i = 0; i < GEN_COUNT; i++) {
+        bench_one(&sequence_generators[i]);
+    }
+}
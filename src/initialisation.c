@@ -3,6 +3,7 @@
  * @brief Initialization routines for microcontroller peripherals
  * 
  * This module contains initialization functions for:
+ * - Main clock prescaler for the selected F_CPU profile
  * - Timer configuration for interrupt generation
  * - ADC setup for potentiometer reading
  * - Button input configuration
@@ -12,32 +13,71 @@
  */
 
 #include "initialisation.h"
+#include "reaction.h"
+#include "clock.h"
+#include "buzzer.h"
+#include "symbols.h"
+#include "ccl_filter.h"
+#include "press_bench.h"
+#include <avr/cpufunc.h>
 #include <avr/io.h>
 
+/**
+ * Sets the main clock prescaler for the selected F_CPU
+ *
+ * CLK_PER = OSC20M / prescaler (see clock.h). MCLKCTRLB is
+ * protected by the configuration change protection register.
+ */
+void clock_init(void) {
+    _PROTECTED_WRITE(CLKCTRL.MCLKCTRLB, CLOCK_MCLKCTRLB);
+}
+
 /**
  * Initializes system timers for interrupt generation
  * 
  * Configures two TCB timers:
  * TCB1: 5ms interval timer
- * - CCMP = 16667 for 5ms period at 3.3MHz
+ * - CCMP = TIMER_MUX_CCMP, exactly five TCB0 periods so display
+ *   dimming stays in phase with multiplexing
  * - Configured in interrupt mode
  * 
  * TCB0: 1ms interval timer
- * - CCMP = 3333 for 1ms period at 3.3MHz
+ * - CCMP = TIMER_TICK_CCMP (3332 at 3.33MHz)
  * - Used for system timing
+ *
+ * Both count CLK_PER, or CLK_PER/2 when a 5ms period would not fit
+ * in 16 bits (clock.h).
+ *
+ * In the timed game mode TCB1 instead runs free at CLK_PER/2 in input
+ * capture mode, latching the counter on falling edges from EVSYS
+ * channel 0 (a button pin, routed per step by reaction_arm()).
  */
 void timers_init(void) {
+#if REACTION_MODE
+    /* Configure TCB1 for button edge capture */
+    EVSYS.USERTCB1CAPT = EVSYS_USER_CHANNEL0_gc; // Capture events from channel 0
+    TCB1.CTRLB = TCB_CNTMODE_CAPT_gc;            // Input capture on event
+    TCB1.EVCTRL = TCB_CAPTEI_bm |                // Enable capture event input
+                  TCB_EDGE_bm |                  // Falling edge (button press)
+                  TCB_FILTER_bm;                 // Noise cancellation filter
+    TCB1.INTCTRL = TCB_CAPT_bm | TCB_OVF_bm;     // Capture and overflow interrupts
+    TCB1.CTRLA = TCB_CLKSEL_DIV2_gc |            // CLK_PER/2 timebase
+                 TCB_ENABLE_bm;                  // Start the timer
+#else
     /* Configure TCB1 for 5ms intervals */
-    TCB1.CCMP = 16667;               // Set compare match value (5ms @ 3.3MHz)
+    TCB1.CCMP = TIMER_MUX_CCMP;      // Set compare match value (5 ticks)
     TCB1.CTRLB = TCB_CNTMODE_INT_gc; // Configure for interrupt mode
     TCB1.INTCTRL = TCB_CAPT_bm;      // Enable capture interrupt
-    TCB1.CTRLA = TCB_ENABLE_bm;      // Start the timer
+    TCB1.CTRLA = TIMER_TCB_CLKSEL |  // Select timer clock
+                 TCB_ENABLE_bm;      // Start the timer
+#endif
 
     /* Configure TCB0 for 1ms intervals */
     TCB0.CNT = 0;                    // Initialize counter to 0
-    TCB0.CCMP = 3333;                // Set compare match value (1ms @ 3.3MHz)
+    TCB0.CCMP = TIMER_TICK_CCMP;     // Set compare match value (1ms)
     TCB0.INTCTRL = TCB_CAPT_bm;      // Enable capture interrupt
-    TCB0.CTRLA = TCB_ENABLE_bm;      // Start the timer
+    TCB0.CTRLA = TIMER_TCB_CLKSEL |  // Select timer clock
+                 TCB_ENABLE_bm;      // Start the timer
 }
 
 /**
@@ -48,17 +88,22 @@ void timers_init(void) {
  * - VDD reference voltage
  * - Input channel: AIN2 (potentiometer)
  * - Left-adjusted result for 8-bit readings
- * - DIV2 prescaler for optimal tone setting
+ * - Prescaler keeps CLK_ADC at or below 2MHz (DIV2 at 3.33MHz)
+ * - Timebase derived from F_CPU (clock.h)
+ *
+ * The first conversion is started here so the reference settles while the
+ * other peripherals are set up; calculate_playback_delay() discards it.
  */
 void adc_init(void) {
     ADC0.CTRLA = ADC_ENABLE_bm;                     // Enable ADC
-    ADC0.CTRLB = ADC_PRESC_DIV2_gc;                 // Set prescaler to 2 for accurate tone generation
-    ADC0.CTRLC = (4 << ADC_TIMEBASE_gp) |          // 4 clock cycles timebase
+    ADC0.CTRLB = ADC_PRESC;                         // Set prescaler for selected F_CPU
+    ADC0.CTRLC = (ADC_TIMEBASE_VALUE << ADC_TIMEBASE_gp) | // CLK_PER cycles per us
                  ADC_REFSEL_VDD_gc;                 // Use VDD as reference
     ADC0.CTRLE = 64;                               // Set sample duration
     ADC0.CTRLF = ADC_LEFTADJ_bm;                   // Left adjust for 8-bit reads
     ADC0.MUXPOS = ADC_MUXPOS_AIN2_gc;             // Select potentiometer input
     ADC0.COMMAND = ADC_MODE_SINGLE_8BIT_gc;        // 8-bit resolution, single-ended
+    ADC0.COMMAND |= ADC_START_IMMEDIATE_gc;         // Prime the first reading
 }
 
 /**
@@ -69,6 +114,8 @@ void adc_init(void) {
  * - S2: PA5 (Button 2)
  * - S3: PA6 (Button 3)
  * - S4: PA7 (Button 4)
+ * Extra symbols wired to PA0-PA3 and listed in SYMBOL_BUTTON_MASK get
+ * pull-ups too (see symbols.h).
  */
 void button_init(void) {
     /* Enable pull-up resistors for all buttons */
@@ -76,6 +123,14 @@ void button_init(void) {
     PORTA.PIN5CTRL = PORT_PULLUPEN_bm; // S2
     PORTA.PIN6CTRL = PORT_PULLUPEN_bm; // S3
     PORTA.PIN7CTRL = PORT_PULLUPEN_bm; // S4
+
+#if SYMBOL_BUTTON_MASK & 0x0F
+    PORTA.PINCONFIG = PORT_PULLUPEN_bm;               // S5-S8
+    PORTA.PINCTRLUPD = SYMBOL_BUTTON_MASK & 0x0F;
+#endif
+
+    ccl_filter_init();   // Hardware glitch filter (CCL_FILTER builds)
+    press_bench_init();  // Press latency edge stamps (PRESS_BENCH builds)
 }
 
 /**
@@ -83,6 +138,7 @@ void button_init(void) {
  * 
  * Configuration:
  * - DISP LATCH: PA1 (output)
+ * - DISP EN: PB1 (output, active low, used for dimming)
  * - SPI CLK: PC0 (output)
  * - SPI MOSI: PC2 (output)
  * - Uses alternate pin configuration
@@ -93,6 +149,10 @@ void spi_init(void) {
     PORTA.OUTCLR = PIN1_bm;          // Initialize latch low
     PORTA.DIRSET = PIN1_bm;          // Set as output
 
+    /* Configure display enable pin */
+    PORTB.OUTCLR = PIN1_bm;          // Enable display (active low)
+    PORTB.DIRSET = PIN1_bm;          // Set as output
+
     /* Configure SPI pins */
     PORTC.DIRSET = PIN0_bm | PIN2_bm; // Set CLK and MOSI as outputs
     PORTMUX.SPIROUTEA = PORTMUX_SPI0_ALT1_gc; // Use alternate pin configuration
@@ -110,14 +170,26 @@ void spi_init(void) {
  * Configuration:
  * - Uses TCA0 in single-slope PWM mode
  * - Output on PB0 (buzzer pin)
- * - DIV2 prescaler for accurate frequency generation
+ * - Prescaler auto-ranged at compile time so every note fits the
+ *   16-bit period (DIV4 at 3.33MHz, see clock.h)
  * - Initially configured with output disabled
+ * 
+ * In DUAL_VOICE builds TCA0 is split into two 8-bit timers instead,
+ * voice 0 on PB0 (WO0) and voice 1 on PA3 (WO3); buzzer.c sets the
+ * prescaler per chord.
  */
 void pwm_init(void) {
     PORTB.DIRSET = PIN0_bm;          // Set buzzer pin as output
 
+#if DUAL_VOICE
+    PORTA.DIRSET = PIN3_bm;          // Set voice 1 pin as output
+
+    TCA0.SPLIT.CTRLD = TCA_SPLIT_SPLITM_bm;    // Two 8-bit timers
+    TCA0.SPLIT.CTRLB = 0;                      // Both voices silent
+    TCA0.SPLIT.CTRLA = TCA_SPLIT_ENABLE_bm;    // Enable timer
+#else
     /* Configure Timer/Counter A */
-    TCA0.SINGLE.CTRLA = TCA_SINGLE_CLKSEL_DIV2_gc; // Set prescaler to 2
+    TCA0.SINGLE.CTRLA = TONE_CLKSEL;               // Set tone prescaler
     TCA0.SINGLE.CTRLB = TCA_SINGLE_WGMODE_SINGLESLOPE_gc | // Single-slope PWM mode
                         TCA_SINGLE_CMP0EN_bm;               // Enable compare output
 
@@ -126,20 +198,21 @@ void pwm_init(void) {
     TCA0.SINGLE.CMP0 = 0;
 
     TCA0.SINGLE.CTRLA |= TCA_SINGLE_ENABLE_bm; // Enable timer
+#endif
 }
 
 /**
  * Initializes UART for serial communication
  * 
  * Configuration:
- * - Baud rate: 9600 bps (BAUD = 1389 for 3.3MHz clock)
+ * - Baud rate: UART_BAUD (9600 bps default, BAUD = 1389 at 3.3MHz)
  * - Uses PB2 for TXD
  * - Enables both transmitter and receiver
  * - Enables receive complete interrupt
  */
 void uart_init(void) {
     PORTB.DIRSET = PIN2_bm;          // Set TXD pin as output
-    USART0.BAUD = 1389;              // Set baud rate to 9600 @ 3.3MHz
+    USART0.BAUD = UART_BAUD_VALUE;   // Set baud rate derived from F_CPU
     USART0.CTRLA = USART_RXCIE_bm;   // Enable receive interrupt
     USART0.CTRLB = USART_RXEN_bm |   // Enable receiver
                    USART_TXEN_bm;     // Enable transmitter
@@ -18,6 +18,9 @@
 #include "lsfr.h"
 #include "buzzer.h"
 #include "spi.h"
+#include "replay.h"
+#include "reaction.h"
+#include "irq.h"
 
 /**
  * Button state tracking variables:
@@ -27,9 +30,9 @@
  * pb_changed: Mask of buttons that changed state
  * pb_falling: Mask of buttons that were just pressed
  * pb_rising: Mask of buttons that were just released
- * button_active: Flag indicating active button processing
- * pb_released: Flag indicating button release detected
- * pushbutton_received: Flag for button input acknowledgment
+ *
+ * Press and round state (button_active, pb_released, player_input,
+ * sequence_position, ...) is kept in the game context, see game.h.
  */
 uint8_t pb_sample = 0xFF;
 uint8_t pb_sample_r = 0xFF;
@@ -37,52 +40,35 @@ volatile uint8_t pb_debounced_state = 0xFF;
 uint8_t pb_changed;
 uint8_t pb_falling;
 uint8_t pb_rising;
-volatile uint8_t button_active = 0;
-uint8_t pb_released = 0;
-uint8_t pushbutton_received = 0;
-
-/**
- * Game state variables:
- * player_input: Flag indicating player has provided input
- * sequence_position: Current position in the sequence being matched
- * sequence_matched: Flag indicating if player's input matches expected sequence
- */
-uint8_t player_input = 0;
-uint8_t sequence_position = 0;
-uint8_t sequence_matched = 1;
 
 /**
  * Button mapping structure array
  * Maps physical pins to logical button identifiers
- * S1-S4 correspond to game buttons
+ * S1-S4 correspond to game buttons, S5-S8 to the extra symbols (symbols.h)
  */
-button_pin mapped_array[4] = {
-    {PIN4_bm, S1},
-    {PIN5_bm, S2},
-    {PIN6_bm, S3},
-    {PIN7_bm, S4}
+button_pin mapped_array[SYMBOL_COUNT] = {
+    {SYMBOL_PIN(0), S1},
+    {SYMBOL_PIN(1), S2},
+#if SYMBOL_COUNT > 2
+    {SYMBOL_PIN(2), S3},
+#endif
+#if SYMBOL_COUNT > 3
+    {SYMBOL_PIN(3), S4},
+#endif
+#if SYMBOL_COUNT > 4
+    {SYMBOL_PIN(4), S5},
+#endif
+#if SYMBOL_COUNT > 5
+    {SYMBOL_PIN(5), S6},
+#endif
+#if SYMBOL_COUNT > 6
+    {SYMBOL_PIN(6), S7},
+#endif
+#if SYMBOL_COUNT > 7
+    {SYMBOL_PIN(7), S8},
+#endif
 };
 
-/**
- * Implements button debouncing using vertical counter method
- * 
- * The vertical counter method uses two counter bits per input to
- * filter out noise and provide stable button states. A button state
- * change is only registered after multiple consistent samples.
- */
-void pb_debounce(void) {
-    static uint8_t count0 = 0; 
-    static uint8_t count1 = 0; 
-
-    uint8_t pb_sample = PORTA.IN;    
-    uint8_t pb_changed = (pb_sample ^ pb_debounced_state); 
-
-    count1 = (count1 ^ count0) & pb_changed;
-    count0 = ~count0 & pb_changed;
-
-    pb_debounced_state ^= (count0 & count1);
-}
-
 /**
  * Detects edge transitions (press/release) for buttons
  * 
@@ -90,10 +76,23 @@ void pb_debounce(void) {
  * - Rising edges (button releases)
  * - Falling edges (button presses)
  * Updates global state variables for edge detection
+ * 
+ * Skips the comparison unless the debounce ISR has flagged a change;
+ * during replay the scripted state can change at any pass.
  */
 void check_edge(void) {
+#if REPLAY_MODE != REPLAY_PLAYBACK
+    if (!flag_test(FLAG_INPUT_PENDING)) {
+        pb_changed = 0;
+        pb_falling = 0;
+        pb_rising = 0;
+        return;
+    }
+    flag_clear(FLAG_INPUT_PENDING);  // Before the read, so no change is missed
+#endif
+
     pb_sample_r = pb_sample;         // Save previous sample
-    pb_sample = pb_debounced_state;  // Get current sample
+    pb_sample = replay_buttons(pb_debounced_state);  // Get current sample
 
     pb_changed = pb_sample_r ^ pb_sample;  // Detect any changes
 
@@ -104,7 +103,7 @@ void check_edge(void) {
 /**
  * Processes a button press event
  * 
- * @param button_index Index of the button being processed (0-3)
+ * @param button_index Index of the button being processed (0 to SYMBOL_COUNT-1)
  * 
  * Handles:
  * - Button sound feedback
@@ -114,6 +113,7 @@ void check_edge(void) {
  * - State transitions
  */
 void button_press(uint8_t button_index) {
+    game_t *const g = game_context();
     const uint8_t button_pin = mapped_array[button_index].pin;
     
     /* Activate feedback for button press */
@@ -121,22 +121,22 @@ void button_press(uint8_t button_index) {
     display_digit(button_index);
 
     /* Check if pressed button matches sequence */
-    if (step != button_index) {
-        sequence_matched = 0;
+    if (g->step != button_index) {
+        g->sequence_matched = 0;
     }
 
     /* Handle button release and state transition */
-    if (!pb_released) {
-        if ((pb_rising & button_pin) || !pushbutton_received) {
-            pb_released = 1;
-            pushbutton_received = 0;
+    if (!g->pb_released) {
+        if ((pb_rising & button_pin) || !g->pushbutton_received) {
+            g->pb_released = 1;
+            g->pushbutton_received = 0;
         }
-    } else if (playback_timer >= (playback_delay >> 1)) {
+    } else if (ticks_since(g->press_start) >= (playback_delay >> 1)) {
         buzzer_off();
-        display_digit(4);
-        player_input = 1;
-        pb_released = 0;
-        button = COMPLETE;
+        display_digit(DISP_STEP_OFF);
+        g->player_input = 1;
+        g->pb_released = 0;
+        g->button = COMPLETE;
     }
 }
 
@@ -147,11 +147,19 @@ void button_press(uint8_t button_index) {
  * - Button debouncing
  * - SPI display updates
  * 
- * Note: Triggered by TCB1 timer every 5ms
+ * Both are inlined, so the handler makes no calls and its prologue only
+ * saves the registers it uses.
+ * 
+ * Note: Triggered by TCB1 timer every 5ms. In the timed game mode TCB1
+ * captures button edges instead and these tasks run from the TCB0 ISR.
  */
+#if !REACTION_MODE
 ISR(TCB1_INT_vect) {
+    irq_latency_sample(IRQ_TCB1, TCB1.CNT);  // Counts since the flag was set
     pb_debounce();    // Update button debouncing
     spi_write();      // Update display via SPI
+    irq_done_sample(IRQ_TCB1, TCB1.CNT);     // Counts to the end of the work
     
     TCB1.INTFLAGS = TCB_CAPT_bm;  // Clear interrupt flag
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+/**
+ * @file irq.c
+ * @brief Interrupt priority plan and worst-case latency measurement
+ *
+ * The 1ms time base is the only level 1 (high priority) interrupt; the
+ * rest share level 0 in round-robin order (see irq.h). With -DIRQ_LATENCY=1
+ * the periodic timer handlers also record the longest time from their
+ * interrupt flag to handler entry and to the end of their work.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/cpufunc.h>
+#include "irq.h"
+#include "clock.h"
+#include "uart_format.h"
+
+/**
+ * Configures interrupt levels
+ *
+ * Call before interrupts are enabled. CPUINT.CTRLA is written under
+ * configuration change protection.
+ */
+void irq_init(void) {
+    CPUINT.LVL1VEC = TCB0_INT_vect_num;                 // Time base preempts level 0
+    _PROTECTED_WRITE(CPUINT.CTRLA, CPUINT_LVL0RR_bm);  // Round-robin level 0
+}
+
+#if IRQ_LATENCY
+
+/* Worst-case counts per vector, in timer clocks (TIMER_TCB_DIV cycles) */
+volatile uint16_t irq_latency_max[IRQ_COUNT];
+volatile uint16_t irq_done_max[IRQ_COUNT];
+
+static const char name_tcb0[] PROGMEM = "tcb0";
+static const char name_tcb1[] PROGMEM = "tcb1";
+
+static const char *const vector_names[IRQ_COUNT] = {
+    [IRQ_TCB0] = name_tcb0,
+    [IRQ_TCB1] = name_tcb1
+};
+
+/**
+ * Reports the worst-case latencies since the last report and clears them
+ *
+ * "worst" is flag to handler entry, "done" flag to the end of the handler
+ * body. Cycles are CPU clocks, resolved to TIMER_TCB_DIV; microseconds
+ * are rounded down.
+ */
+void irq_latency_report(void) {
+    for (uint8_t i = 0; i < IRQ_COUNT; i++) {
+        uint8_t sreg = SREG;
+        cli();
+        uint16_t worst = irq_latency_max[i];
+        uint16_t done = irq_done_max[i];
+        irq_latency_max[i] = 0;
+        irq_done_max[i] = 0;
+        SREG = sreg;
+
+        uint32_t cycles = (uint32_t)worst * TIMER_TCB_DIV;
+        uint32_t done_cycles = (uint32_t)done * TIMER_TCB_DIV;
+        uart_printf("%S: worst %lu cycles (%lu us) done %lu cycles\n", vector_names[i],
+                    cycles, cycles * 1000 / (F_CPU / 1000), done_cycles);
+    }
+}
+
+#endif
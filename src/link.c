@@ -0,0 +1,325 @@
+/**
+ * @file link.c
+ * @brief Two-board versus play over USART0
+ *
+ * Both boards play the same sequence and race each other; the first
+ * mistake loses. Flow:
+ * 1. START: a button press makes a board the leader, which sends its seed
+ *    and playback delay; the other board adopts them. If both boards lead
+ *    in the same window, the lower seed wins and the other board switches
+ *    to it before round 1 is played
+ * 2. Every round begins with a READY barrier: each board sends READY and
+ *    waits for the peer's, so playback starts within one byte time (~1ms
+ *    at 9600 baud) plus a main loop pass on both boards
+ * 3. Each correct step sends PROGRESS, shown on the peer's display while
+ *    it waits for input
+ * 4. A mistake sends FAIL; the peer reports a win
+ *
+ * Received link bytes are queued by the RX ISR and decoded in link_poll()
+ * from the main loop. scripts/link_peer.py emulates a peer on the host.
+ */
+
+#include <avr/io.h>
+#include "link.h"
+#include "uart.h"
+#include "uart_format.h"
+#include "lsfr.h"
+#include "timer.h"
+#include "display.h"
+#include "states_m.h"
+#include "replay.h"
+
+#if VERSUS_MODE
+
+#define LINK_RX_SIZE 16
+
+/* Receive ring shared with the RX ISR */
+static volatile uint8_t rx_ring[LINK_RX_SIZE];
+static volatile uint8_t rx_head;
+static volatile uint8_t rx_tail;
+static uint8_t rx_payload_left;     // Payload bytes still owed (ISR only)
+static uint8_t peer_heard;          // Flag set by the first link header (ISR only)
+
+/* Message decoder state */
+static uint8_t message[1 + LINK_SEED_PAYLOAD];
+static uint8_t message_length;      // Bytes collected, 0 = waiting for header
+static uint8_t message_expected;    // Total bytes in the current message
+
+/* Game synchronisation state */
+static uint8_t seed_received;       // Flag set when the peer sent a seed
+static uint8_t leading;             // Flag set when our seed started the game
+static uint8_t ready_sent;          // Flag set once READY was sent this round
+static uint8_t peer_ready = 0xFF;   // Round number of the peer's READY
+static uint8_t synced_round = 0xFF; // Round number both boards are in
+static uint8_t peer_failed;         // Flag set when the peer lost
+static uint32_t ping_sent_at;       // Tick the last PING was sent
+
+/**
+ * Executes a complete received message
+ */
+static void handle_message(void) {
+    uint8_t type = (message[0] >> 4) & 0x07;
+
+    uint32_t seed;
+    uint16_t tempo;
+
+    switch (type) {
+    case LINK_SEED:
+        seed = ((uint32_t)(message[0] & 0x0F) << 28) |  // Top nibble in header
+               ((uint32_t)message[1] << 21) | ((uint32_t)message[2] << 14) |
+               ((uint32_t)message[3] << 7) | message[4];
+        tempo = ((uint16_t)message[5] << 7) | message[6];
+
+        if (game.stage != START && !peer_failed) {
+            /*
+             * Both boards led: keep the lower seed (then tempo) so both
+             * play the same game. Round 1 has not been played while
+             * synced_round is unset, and the peer's READY always follows
+             * its SEED, so switching here is still in time. Any other
+             * SEED once past START is ignored.
+             */
+            if (leading && synced_round == 0xFF &&
+                (seed < game.seed ||
+                 (seed == game.seed && tempo < playback_delay_override))) {
+                game.seed = seed;
+                playback_delay_override = tempo;
+                leading = 0;
+                replay_start();  // Log the seed actually played
+            }
+            break;
+        }
+        game.seed = seed;
+        playback_delay_override = tempo;
+        seed_received = 1;
+        break;
+
+    case LINK_READY:
+        peer_ready = message[0] & 0x0F;
+        break;
+
+    case LINK_PROGRESS:
+        /* Show the opponent's progress while waiting for our own input */
+        if (game.stage == INPUT && game.button == COMPLETE) {
+            uint8_t ones = message[1];
+            uint8_t tens = 0;
+            while (ones >= 10) {
+                ones -= 10;
+                tens++;
+            }
+            update_display(segments[tens < 10 ? tens : 9], segments[ones]);
+        }
+        break;
+
+    case LINK_FAIL:
+        peer_failed = 1;
+        break;
+
+    case LINK_PING:
+        uart_putc(LINK_HEADER(LINK_PONG, 0));
+        break;
+
+    case LINK_PONG:
+        uart_printf("link rtt: %lu ms\n", ticks_since(ping_sent_at));
+        break;
+    }
+}
+
+/**
+ * Returns the number of payload bytes that follow a header
+ */
+static uint8_t payload_length(uint8_t header) {
+    switch ((header >> 4) & 0x07) {
+    case LINK_SEED:
+        return LINK_SEED_PAYLOAD;
+    case LINK_PROGRESS:
+        return LINK_PROGRESS_PAYLOAD;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Queues a received byte if it belongs to a link message (RX ISR)
+ *
+ * The link shares USART0 with text output, so once a peer board has been
+ * heard from, ASCII on the line is its score, prompt and console text.
+ * Passing that on would press buttons ('1'-'4', 'e' and 'r' in "Enter
+ * name"), open the console on ':' and bounce "commands:" replies between
+ * the boards, so it is claimed and dropped until the next reset.
+ *
+ * @param byte Byte received
+ * @return Non-zero if the byte was a link header or payload byte, or peer
+ *         text to drop; zero if it is ordinary console or game input
+ */
+uint8_t link_receive(uint8_t byte) {
+    if (byte & 0x80) {
+        rx_payload_left = payload_length(byte);
+        peer_heard = 1;
+    } else if (rx_payload_left) {
+        rx_payload_left--;
+    } else {
+        return peer_heard;  // Peer text once linked, otherwise local input
+    }
+
+    uint8_t next = (rx_head + 1) & (LINK_RX_SIZE - 1);
+    if (next != rx_tail) {
+        rx_ring[rx_head] = byte;
+        rx_head = next;
+    }
+    return 1;
+}
+
+/**
+ * Decodes queued link bytes (called from the main loop)
+ *
+ * A header byte always starts a new message, so a lost payload byte only
+ * drops the message it belonged to.
+ */
+void link_poll(void) {
+    while (rx_tail != rx_head) {
+        uint8_t byte = rx_ring[rx_tail];
+        rx_tail = (rx_tail + 1) & (LINK_RX_SIZE - 1);
+
+        if (byte & 0x80) {
+            message[0] = byte;
+            message_length = 1;
+            message_expected = 1 + payload_length(byte);
+        } else if (message_length && message_length < message_expected) {
+            message[message_length++] = byte;
+        } else {
+            continue;  // Stray payload byte
+        }
+
+        if (message_length == message_expected) {
+            message_length = 0;
+            handle_message();
+        }
+    }
+}
+
+/**
+ * Clears round synchronisation at the end of a game
+ */
+static void reset_rounds(void) {
+    leading = 0;
+    ready_sent = 0;
+    peer_ready = 0xFF;
+    synced_round = 0xFF;
+}
+
+/**
+ * Agrees a seed and tempo with the peer before a game
+ *
+ * @param pressed Buttons pressed this pass (pb_falling)
+ * @return Non-zero once both boards share a seed
+ *
+ * The first board with a button press leads and sends its seed (top
+ * nibble in the header, then four 7-bit bytes) and its playback delay
+ * (two 7-bit bytes), which the follower uses as a fixed delay. A SEED
+ * from the peer that crosses ours is settled in handle_message().
+ */
+uint8_t link_game_ready(uint8_t pressed) {
+    peer_failed = 0;
+
+    /* Keep any READY the leader sent straight after its seed */
+    if (seed_received) {
+        seed_received = 0;
+        return 1;
+    }
+
+    if (pressed) {
+        reset_rounds();
+
+        /* Read our own pot, not a tempo adopted in an earlier game */
+        playback_delay_override = 0;
+        calculate_playback_delay();
+        uint16_t tempo = playback_delay;
+
+        uart_putc(LINK_HEADER(LINK_SEED, game.seed >> 28));
+        uart_putc((game.seed >> 21) & 0x7F);
+        uart_putc((game.seed >> 14) & 0x7F);
+        uart_putc((game.seed >> 7) & 0x7F);
+        uart_putc(game.seed & 0x7F);
+        uart_putc((tempo >> 7) & 0x7F);
+        uart_putc(tempo & 0x7F);
+        playback_delay_override = tempo;
+        leading = 1;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Waits at the start of a round until the peer is ready too
+ *
+ * @param sequence_length Round about to be played
+ * @return Non-zero when both boards are ready
+ *
+ * Keeps returning non-zero for the rest of the round, since the
+ * START_SEQUENCE stage may take several passes to start playback.
+ */
+uint8_t link_round_ready(uint16_t sequence_length) {
+    uint8_t round = sequence_length & 0x0F;
+
+    if (synced_round == round) {
+        return 1;
+    }
+    if (!ready_sent) {
+        uart_putc(LINK_HEADER(LINK_READY, round));
+        ready_sent = 1;
+    }
+    if (peer_ready == round) {
+        peer_ready = 0xFF;
+        ready_sent = 0;
+        synced_round = round;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Reports a correct step to the peer
+ *
+ * @param position Steps matched so far this round
+ *
+ * Clamped to 99, the most the peer's display can show.
+ */
+void link_progress(uint16_t position) {
+    uart_putc(LINK_HEADER(LINK_PROGRESS, 0));
+    uart_putc(position > 99 ? 99 : position);
+}
+
+/**
+ * Reports a mistake to the peer, which then wins
+ */
+void link_lost(void) {
+    uart_putc(LINK_HEADER(LINK_FAIL, 0));
+    reset_rounds();
+}
+
+/**
+ * Returns non-zero once when the peer has reported a mistake
+ *
+ * @param playing Non-zero while a round is being played or entered
+ *
+ * A FAIL only wins a game in progress. One that arrives after this board
+ * has failed too, or at START, is dropped.
+ */
+uint8_t link_peer_lost(uint8_t playing) {
+    if (peer_failed) {
+        peer_failed = 0;
+        reset_rounds();
+        return playing;
+    }
+    return 0;
+}
+
+/**
+ * Sends a PING; the round-trip time is printed when the PONG arrives
+ */
+void link_ping(void) {
+    ping_sent_at = ticks_now();
+    uart_putc(LINK_HEADER(LINK_PING, 0));
+}
+
+#endif /* VERSUS_MODE */
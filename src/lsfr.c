@@ -5,50 +5,122 @@
  * This module implements a Linear Feedback Shift Register (LFSR) to generate
  * pseudo-random sequences for game patterns. The LFSR uses a 32-bit state
  * with specific feedback taps to ensure maximum sequence length.
+ * 
+ * Alternative backends (multi-shift LFSR, xorshift32) share the same step
+ * interface and are selected with SEQUENCE_GENERATOR; generator_bench.c
+ * compares their quality and speed.
  */
 
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 #include "lsfr.h"
 
-/**
- * LFSR state variables:
- * 
- * seed: Initial value for the LFSR (0x11638494)
- * state_sequence: Current state of the LFSR
- * step: Current 2-bit output value (0-3)
- * result: Latest single bit output from LFSR
- * 
- * The seed value is chosen to prevent the LFSR from entering a zero state,
- * ensuring proper sequence generation.
+/*
+ * The seed and generator state live in the game context (game.h); the
+ * generators below only see the state through their arguments.
  */
-uint32_t seed = 0x11638494;           // Initial seed value
-uint32_t state_sequence;              // Current LFSR state
-uint8_t step;                         // Current sequence step (0-3)
-uint8_t result;                       // Latest LFSR output bit
 
 /**
- * Generates the next value in the LFSR sequence
+ * Galois LFSR backend (default): one shift per step
  * 
  * @param state Pointer to the current LFSR state
- * @param step Pointer to store the 2-bit output (0-3)
+ * @param step Pointer to store the SYMBOL_BITS-bit draw (0-3 by default)
  * @param result Pointer to store the single bit result
  * 
  * Algorithm:
  * 1. Extract least significant bit as result
  * 2. Right shift the state by 1
  * 3. If result is 1, XOR the state with LSFR_MASK
- * 4. Extract 2 least significant bits as step value
+ * 4. Extract SYMBOL_BITS least significant bits as step value
  * 
  * The LSFR_MASK is defined to create maximum-length sequences,
  * typically using polynomials like x^32 + x^31 + x^29 + x + 1
+ * 
+ * Consecutive steps share a state bit, so they are correlated.
  */
-void SEQUENCE(uint32_t *state, uint8_t *step, uint8_t *result) {
+static void lfsr_next(uint32_t *state, uint8_t *step, uint8_t *result) {
     *result = *state & 1u;            // Extract LSB
     *state >>= 1;                     // Shift right by 1
     
     if (*result) {
         *state ^= LSFR_MASK;          // Apply feedback polynomial
     }
-    *step = *state & 0x3u;            // Extract 2 LSBs for step value
+    *step = *state & SYMBOL_BITS_MASK;  // Extract LSBs for step value
+}
+
+/**
+ * Multi-shift Galois LFSR backend: SYMBOL_BITS shifts per step
+ * 
+ * The step is built from the bits shifted out, so every step uses
+ * fresh output bits of the m-sequence and steps do not overlap.
+ */
+static void lfsr_multi_next(uint32_t *state, uint8_t *step, uint8_t *result) {
+    uint8_t bits = 0;
+
+    for (uint8_t i = 0; i < SYMBOL_BITS; i++) {
+        *result = *state & 1u;
+        *state >>= 1;
+        if (*result) {
+            *state ^= LSFR_MASK;
+        }
+        bits = (bits << 1) | *result;
+    }
+    *step = bits;
+}
+
+/**
+ * Xorshift32 backend (shifts 13, 17, 5)
+ * 
+ * The step is taken from the most significant bits, which are the
+ * best mixed. The state must never be zero.
+ */
+static void xorshift_next(uint32_t *state, uint8_t *step, uint8_t *result) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    *step = x >> (32 - SYMBOL_BITS);
+    *result = *step & 1u;
+}
+
+static const char name_lfsr[] PROGMEM = "lfsr";
+static const char name_lfsr_multi[] PROGMEM = "lfsr-multi";
+static const char name_xorshift[] PROGMEM = "xorshift";
+
+/**
+ * Table of all backends, used by the generator benchmark
+ */
+const sequence_generator_t sequence_generators[GEN_COUNT] = {
+    [GEN_LFSR] = {name_lfsr, lfsr_next},
+    [GEN_LFSR_MULTI] = {name_lfsr_multi, lfsr_multi_next},
+    [GEN_XORSHIFT] = {name_xorshift, xorshift_next}
+};
+
+/**
+ * Generates the next step with the backend selected at build time
+ * 
+ * @param state Pointer to the current generator state
+ * @param step Pointer to store the symbol (0 to SYMBOL_COUNT - 1)
+ * @param result Pointer to store the single bit result
+ * 
+ * When SYMBOL_COUNT is not a power of two, draws at or above it are
+ * rejected and redrawn, so every symbol is equally likely. Power-of-two
+ * alphabets use each draw directly.
+ */
+void SEQUENCE(uint32_t *state, uint8_t *step, uint8_t *result) {
+#if SYMBOL_COUNT & (SYMBOL_COUNT - 1)
+    do {
+#endif
+#if SEQUENCE_GENERATOR == GEN_LFSR_MULTI
+        lfsr_multi_next(state, step, result);
+#elif SEQUENCE_GENERATOR == GEN_XORSHIFT
+        xorshift_next(state, step, result);
+#else
+        lfsr_next(state, step, result);
+#endif
+#if SYMBOL_COUNT & (SYMBOL_COUNT - 1)
+    } while (*step >= SYMBOL_COUNT);
+#endif
 }
\ No newline at end of file
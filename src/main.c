@@ -16,43 +16,63 @@
 #include "timer.h"
 #include "states_m.h"
 #include "uart.h"
+#include "uart_format.h"
 #include "input.h"
 #include "lsfr.h"
 #include "main.h"
 #include "buzzer.h"
 #include "display.h"
-
-/**
- * State machine enums for game control:
- * button: Tracks current button state/processing
- * stage: Tracks overall game progression
- */
-buttons button = COMPLETE;
-simon_stage stage = START;
+#include "replay.h"
+#include "stack.h"
+#include "reaction.h"
+#include "score.h"
+#include "console.h"
+#include "link.h"
+#include "typeahead.h"
+#include "settings.h"
+#include "startup.h"
+#include "endurance.h"
+#include "self_play.h"
+#include "tempo.h"
+#include "game.h"
+#include "clock_governor.h"
 
 /**
  * Processes button input events and updates game state
  * 
  * Checks for button press events and:
  * - Generates next sequence step
- * - Resets playback timer
+ * - Timestamps the press
  * - Updates sequence position
  * - Sets active button state
+ * 
+ * In typeahead mode presses queued before INPUT are taken first.
  */
 static inline void check_button_input(void) {
-    for (int i = 0; i < 4; i++) {
+    game_t *const g = game_context();
+    uint8_t pressed = pb_falling | replay_key(g->button_active);
+    uint8_t physical = pb_falling;
+    const uint8_t queued = typeahead_next(&pressed);
+
+    if (queued) {
+        physical = 0;  // Queued presses are already released
+    }
+
+    for (int i = 0; i < SYMBOL_COUNT; i++) {
         /* Check for new button press or active button */
-        if ((pb_falling | button_active) & mapped_array[i].pin) {
-            SEQUENCE(&state_sequence, &step, &result);  // Generate next step
-            button_active = 0;
-            playback_timer = 0;
-            sequence_position++;
-            button = mapped_array[i].button;
+        if (pressed & mapped_array[i].pin) {
+            SEQUENCE(&g->state_sequence, &g->step, &g->result);  // Generate next step
+            reaction_step_end(g->step == i && !queued);          // Time the response
+            g->button_active = 0;
+            counters.presses++;
+            g->press_start = ticks_now();
+            g->sequence_position++;
+            g->button = mapped_array[i].button;
         }
 
         /* Register button press */
-        if (pb_falling & mapped_array[i].pin) {
-            pushbutton_received = 1;
+        if (physical & mapped_array[i].pin) {
+            g->pushbutton_received = 1;
         }
     }
 }
@@ -60,7 +80,8 @@ static inline void check_button_input(void) {
 /**
  * Plays back the sequence for player to memorize
  * 
- * @param sequence_length Current length of sequence to play
+ * @param sequence_length Steps to play (from the endurance checkpoint,
+ *                        if any, otherwise the whole sequence)
  * 
  * For each step in sequence:
  * - Generates next sequence step
@@ -69,25 +90,31 @@ static inline void check_button_input(void) {
  * - Resets sequence state for player input
  */
 static inline void play_sequence(uint16_t sequence_length) {
-    if (adc_ready_flag) {   
-        for (int i = 0; i < sequence_length; i++) {
-            SEQUENCE(&state_sequence, &step, &result);
-            buzzer_on(step);
-            display_digit(step);
-            half_of_delay();
-            buzzer_off();
-            display_digit(4);
-            half_of_delay();
-        }
-        state_sequence = seed;  // Reset sequence for player input
-        stage = INPUT;
+    game_t *const g = game_context();
+    self_play_playback(sequence_length);  // Soak test: time playback
+    for (uint16_t i = 0; i < sequence_length; i++) {
+        SEQUENCE(&g->state_sequence, &g->step, &g->result);
+        buzzer_on(g->step);
+        startup_first_tone();   // Stamp the first note after reset
+        display_digit(g->step);
+        half_of_delay();
+        buzzer_off();
+        display_digit(DISP_STEP_OFF);
+        half_of_delay();
     }
+    self_play_round_start();  // Soak test: shadow the round
+    startup_report();       // Once, after the first playback
+    g->state_sequence = endurance_origin();  // Reset sequence for player input
+    g->stage = INPUT;
+    typeahead_begin();      // Drop early presses outside the window
+    replay_sync();          // Mark input start for record/replay
+    reaction_arm();         // Start timing the first response
 }
 
 /**
  * Processes player's input sequence and determines success/failure
  * 
- * @param sequence_length Current sequence length being matched
+ * @param sequence_length Steps to match this round (see play_sequence())
  * 
  * Handles:
  * - Sequence matching verification
@@ -96,29 +123,63 @@ static inline void play_sequence(uint16_t sequence_length) {
  * - Score reporting via UART
  */
 static inline void process_user_input(uint16_t sequence_length) {
-    if (player_input) {
-        if (!sequence_matched) {
+    game_t *const g = game_context();
+    if (g->player_input) {
+        if (!g->sequence_matched) {
             /* Handle sequence mismatch */
-            sequence_matched = 1;    
-            sequence_position = 0;     
-            stage = FAIL;
-            uart_puts("GAME OVER\n");
-            send_score(sequence_length - 1);
+            g->sequence_matched = 1;    
+            g->sequence_position = 0;     
+            g->stage = FAIL;
+            link_lost();             // Versus mode: opponent wins
+            uart_puts_F("GAME OVER\n");
+            send_score(&score);
             uart_putc('\n');
+            reaction_round_report();
         } else {
+            link_progress(g->sequence_position);  // Versus mode: report step
+
             /* Check for complete sequence match */
-            if (sequence_position == sequence_length) {
-                sequence_position = 0;  
-                stage = SUCCESS;
-                uart_puts("SUCCESS\n");
-                send_score(sequence_length);
+            if (g->sequence_position == sequence_length) {
+                g->sequence_position = 0;  
+                g->stage = SUCCESS;
+                bcd_add(&score, 1);      // Round completed
+                counters.rounds++;
+                uart_puts_F("SUCCESS\n");
+                send_score(&score);
                 uart_putc('\n');
+                reaction_round_report();
+            } else {
+                reaction_arm();  // Start timing the next response
             }
         }
-        player_input = 0;
+        g->player_input = 0;
     }
 }
 
+/**
+ * Ends the game with a win when the versus opponent has failed
+ * 
+ * Abandons any press in progress, shows the success pattern,
+ * reports the score and returns to START for the next game.
+ */
+static inline void versus_win(void) {
+    game_t *const g = game_context();
+    buzzer_off();
+    g->button = COMPLETE;
+    g->pb_released = 0;
+    g->player_input = 0;
+    g->sequence_position = 0;
+    g->sequence_matched = 1;
+
+    uart_puts_F("YOU WIN\n");
+    send_score(&score);
+    uart_putc('\n');
+    update_display(PATTERN_SUCCESS_LEFT, PATTERN_SUCCESS_RIGHT);
+    delay();
+    display_digit(DISP_STEP_OFF);
+    g->stage = START;
+}
+
 /**
  * Main program entry point and game loop
  * 
@@ -163,7 +224,7 @@ static inline void process_user_input(uint16_t sequence_length) {
  * Button State Machine:
  * 
  * +------------+    Press    +------------+    Release    +-----------+
- * | COMPLETE   |-----------> |  S1-S4     |-------------> | COMPLETE  |
+ * | COMPLETE   |-----------> |  S1-Sn     |-------------> | COMPLETE  |
  * | (Waiting)  |            | (Active)    |   after      | (Ready)   |
  * +------------+            +------------+   delay       +-----------+
  *      ^                    | 1. Sound   |
@@ -174,78 +235,127 @@ static inline void process_user_input(uint16_t sequence_length) {
 int main(void) {
     cli();               // Disable interrupts for initialization
     INIT_ALL_SYSTEMS();
+    settings_load();     // Restore saved settings over the defaults
+    self_play_init();    // Soak test: minimum playback delay
+    startup_stamp(STARTUP_SETTINGS);
     sei();               // Enable interrupts
+    startup_stamp(STARTUP_MAIN_LOOP);
 
-    uint16_t sequence_length;
+    game_t *const g = game_context();
+    endurance_choice_t start;
+    uint8_t pressed;
+    uint8_t left_digit, right_digit;
 
     while (1) {
+        replay_poll();   // Stream recorded or feed replayed input events
         check_edge();    // Check for button edge transitions
 
-        switch (stage) {
+        if (stack_report_requested) {
+            stack_report();  // Send requested memory usage report
+        }
+        console_poll();  // Run any complete console command
+        settings_poll(); // Save changed settings once they settle
+        self_play_poll();  // Soak test: inject the bot's presses
+        link_poll();     // Decode versus link messages
+
+        if (link_peer_lost(g->stage == START_SEQUENCE || g->stage == INPUT)) {
+            versus_win();  // Versus mode: opponent made a mistake
+        }
+
+        /* Idle clock while waiting for a game or for the next press */
+        clock_set(g->stage == START || (g->stage == INPUT && g->button == COMPLETE) ?
+                  CLOCK_IDLE : CLOCK_ACTIVE);
+
+        switch (g->stage) {
         case START:
-            sequence_length = 1;    // Initialize sequence length
-            stage = START_SEQUENCE;
+            pressed = pb_falling | self_play_start_keys();
+            if (!link_game_ready(pressed)) {
+                break;              // Versus mode: wait for a shared seed
+            }
+            start = endurance_choice(pressed);
+            if (start == ENDURANCE_WAIT) {
+                break;              // Endurance mode: resume or restart?
+            }
+            if (start == ENDURANCE_RESUME) {
+                g->sequence_length = endurance_resume();  // Checkpoint, score, level
+            } else {
+                replay_start();     // Log or load the session seed
+                g->sequence_length = 1;  // Initialize sequence length
+                score_reset();      // Score 0, level 1
+                endurance_reset();  // Sequence from the seed, no checkpoint
+            }
+            typeahead_clear();      // Forget presses from the last game
+            reaction_reset();       // Clear speed bonus for the new game
+            counters.games++;
+            g->stage = START_SEQUENCE;
             break;
 
         case START_SEQUENCE:
-            state_sequence = seed;  // Reset sequence generator
+            if (!link_round_ready(g->sequence_length)) {
+                break;              // Versus mode: wait for the peer
+            }
+            g->state_sequence = endurance_origin();  // Reset sequence generator
             calculate_playback_delay();
-            play_sequence(sequence_length);
+            playback_delay = tempo_scale(playback_delay, g->sequence_length);
+            play_sequence(g->sequence_length - endurance_offset());
             break;
 
         case INPUT:
             /* Handle button input state machine */
-            switch (button) {
+            switch (g->button) {
             case COMPLETE:
                 check_button_input();
                 break;
-            case S1:
-                button_press(0);
-                break;
-            case S2:
-                button_press(1);
-                break;
-            case S3:
-                button_press(2);
-                break;
-            case S4:
-                button_press(3);
-                break;
             default:
-                button = COMPLETE;
+                if (g->button <= SYMBOL_COUNT) {
+                    button_press(g->button - S1);  // S1 to the last symbol
+                } else {
+                    g->button = COMPLETE;
+                }
                 break;
             }
-            process_user_input(sequence_length);
+            process_user_input(g->sequence_length - endurance_offset());
             break;
 
         case SUCCESS:
             /* Display success pattern and increment sequence */
             update_display(PATTERN_SUCCESS_LEFT, PATTERN_SUCCESS_RIGHT);
+            buzzer_chord(E_LOW, E_HIGH);   // Octave (dual-voice builds)
             delay();
-            display_digit(4);
-            sequence_length++;
-            stage = START_SEQUENCE;
+            buzzer_chord_off();
+            display_digit(DISP_STEP_OFF);
+            replay_flush();         // Stream recorded events between rounds
+            self_play_round_end(1);
+            score_level_up();       // Keep BCD level in step
+            endurance_checkpoint(g->sequence_length);  // Every n levels
+            g->sequence_length++;
+            g->stage = START_SEQUENCE;
             break;
 
         case FAIL:
             /* Display failure pattern and score */
             update_display(PATTERN_FAIL_LEFT, PATTERN_FAIL_RIGHT);
+            buzzer_chord(C_SHARP, E_HIGH); // Minor third (dual-voice builds)
             delay();
-            extract_digits(sequence_length, &left_digit, &right_digit);
+            buzzer_chord_off();
+            bcd_display_digits(&level, &left_digit, &right_digit);
             update_display(segments[left_digit], segments[right_digit]);
             delay();
-            display_digit(4);
+            display_digit(DISP_STEP_OFF);
             delay();
-            uart_puts("Enter name: ");
+            uart_puts_F("Enter name: ");
             
+            self_play_round_end(0);
+
             /* Update sequence seed for next game */
-            SEQUENCE(&state_sequence, &step, &result);
-            seed = state_sequence;
-            stage = START;
+            SEQUENCE(&g->state_sequence, &g->step, &g->result);
+            g->seed = g->state_sequence;
+            g->stage = START;
             break;
 
         default:
-            stage = START;
+            self_play_anomaly();    // Unknown stage
+            g->stage = START;
             break;
         }
     }
@@ -0,0 +1,116 @@
+/**
+ * @file press_bench.c
+ * @brief Edge-to-accept latency of button presses (-DPRESS_BENCH=1)
+ *
+ * A PORTA falling-edge interrupt on PA4-PA7 stamps the first edge of a
+ * press; later bounces are ignored until that press is accepted. Edges
+ * while the debounced state still reads pressed (release bounce) do not
+ * start a measurement. The accept time is taken in pb_debounce(), in the
+ * ISR, so main loop delays are not counted.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "press_bench.h"
+#include "input.h"
+#include "timer.h"
+#include "uart_format.h"
+
+#if PRESS_BENCH
+
+#define BENCH_PINS (PIN4_bm | PIN5_bm | PIN6_bm | PIN7_bm)
+
+static uint32_t edge_ticks[4];     // First edge of the press in progress
+static uint8_t armed;              // Pins with an edge awaiting acceptance
+
+static uint16_t presses;
+static uint16_t latency_min;
+static uint16_t latency_max;
+static uint32_t latency_sum;
+
+/**
+ * Enables falling-edge interrupts on the button pins
+ *
+ * Only the ISC field is set, keeping the pull-ups.
+ */
+void press_bench_init(void) {
+    PORTA.PINCONFIG = PORT_ISC_FALLING_gc;
+    PORTA.PINCTRLSET = BENCH_PINS;
+    latency_min = UINT16_MAX;
+}
+
+/**
+ * PORTA pin change Interrupt Service Routine
+ *
+ * Stamps the first falling edge of each released button.
+ */
+ISR(PORTA_PORT_vect) {
+    uint8_t edges = PORTA.INTFLAGS & BENCH_PINS;
+    PORTA.INTFLAGS = edges;
+
+    edges &= pb_debounced_state & ~armed;   // New presses only
+    if (edges) {
+        const uint32_t now = ticks_now();
+        for (uint8_t i = 0; i < 4; i++) {
+            if (edges & (PIN4_bm << i)) {
+                edge_ticks[i] = now;
+            }
+        }
+        armed |= edges;
+    }
+}
+
+/**
+ * Records the latency of presses just accepted (called from pb_debounce())
+ *
+ * @param pressed Pins whose debounced state just went low
+ */
+void press_bench_accepted(uint8_t pressed) {
+    pressed &= armed;
+    if (!pressed) {
+        return;
+    }
+    armed &= ~pressed;
+
+    const uint32_t now = ticks_now();
+    for (uint8_t i = 0; i < 4; i++) {
+        if (pressed & (PIN4_bm << i)) {
+            uint16_t latency = now - edge_ticks[i];
+            presses++;
+            latency_sum += latency;
+            if (latency < latency_min) {
+                latency_min = latency;
+            }
+            if (latency > latency_max) {
+                latency_max = latency;
+            }
+        }
+    }
+}
+
+/**
+ * Reports press latency since the last report, then clears it
+ */
+void press_bench_report(void) {
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t count = presses;
+    uint16_t low = latency_min;
+    uint16_t high = latency_max;
+    uint32_t sum = latency_sum;
+    presses = 0;
+    latency_sum = 0;
+    latency_min = UINT16_MAX;
+    latency_max = 0;
+    SREG = sreg;
+
+    if (!count) {
+        uart_puts_F("press: no presses\n");
+        return;
+    }
+    uint32_t mean_x10 = sum * 10 / count;
+    uart_printf("press: %u presses, min %u mean %lu.%lu max %u ms\n",
+                count, low, mean_x10 / 10, mean_x10 % 10, high);
+}
+
+#endif
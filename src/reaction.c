@@ -0,0 +1,187 @@
+/**
+ * @file reaction.c
+ * @brief Reaction-time measurement and speed scoring for the timed game mode
+ *
+ * Each step is timed from the moment the game is ready for it (end of
+ * playback, or completion of the previous step) to the falling edge of the
+ * expected button. The edge is timestamped by hardware:
+ * - EVSYS channel 0 is routed to the pin of the expected button
+ * - TCB1 runs in input capture mode and latches its counter on that edge
+ * - Overflow interrupts extend the 16-bit count to 32 bits
+ *
+ * Only the expected button is routed, since a wrong button ends the round
+ * anyway; wrong presses and UART keys fall back to a software timestamp,
+ * as do symbols without a button in SYMBOL_BUTTON_MASK (their pins drive
+ * the display latch or a voice).
+ * The first edge after arming is kept, so contact bounce does not move it.
+ *
+ * Score: rounds completed plus a speed bonus per correct step
+ * (3/2/1 points under REACTION_FAST_MS/MEDIUM_MS/SLOW_MS), added
+ * straight to the BCD score counter.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "reaction.h"
+#include "input.h"
+#include "lsfr.h"
+#include "uart_format.h"
+#include "score.h"
+
+#if REACTION_MODE
+
+/* Capture timer state shared with the TCB1 ISR */
+static volatile uint16_t capture_overflows;  // Upper 16 bits of the timebase
+static volatile uint32_t capture_time;       // Timestamp of the first edge
+static volatile uint8_t capture_armed;       // Flag accepting the next edge
+
+/* Per-step and per-round statistics, in capture ticks */
+static uint32_t step_start;     // Timestamp when the current step was armed
+static uint32_t round_min;      // Fastest step in the round
+static uint32_t round_max;      // Slowest step in the round
+static uint32_t round_total;    // Sum of step times in the round
+static uint8_t round_steps;     // Steps timed in the round
+
+/**
+ * Reads the 32-bit capture timebase
+ *
+ * @return Current time in capture ticks
+ *
+ * Interrupts are held off briefly because CNT is read through the shared
+ * TEMP register and an overflow may be pending but not yet counted.
+ */
+static uint32_t reaction_now(void) {
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t count = TCB1.CNT;
+    uint16_t high = capture_overflows;
+    if ((TCB1.INTFLAGS & TCB_OVF_bm) && count < 0x8000) {
+        high++;  // Wrapped after the ISR last ran
+    }
+    SREG = sreg;
+    return ((uint32_t)high << 16) | count;
+}
+
+/**
+ * Converts capture ticks to microseconds (report path only)
+ */
+static uint32_t ticks_to_us(uint32_t ticks) {
+    return (ticks / REACTION_TICKS_PER_MS) * 1000 +
+           ((ticks % REACTION_TICKS_PER_MS) * 1000) / REACTION_TICKS_PER_MS;
+}
+
+/**
+ * Clears round statistics at the start of a game
+ */
+void reaction_reset(void) {
+    round_steps = 0;
+    round_total = 0;
+    round_min = UINT32_MAX;
+    round_max = 0;
+}
+
+/**
+ * Starts timing the next step
+ *
+ * Peeks the next sequence step without advancing the generator and routes
+ * that button's pin to the capture timer. Symbols played only from the
+ * UART keymap leave the channel off and are timed in software.
+ */
+void reaction_arm(void) {
+    uint32_t peek_state = game.state_sequence;
+    uint8_t peek_step, peek_result;
+    SEQUENCE(&peek_state, &peek_step, &peek_result);
+
+    if (SYMBOL_PIN(peek_step) & SYMBOL_BUTTON_MASK) {
+        EVSYS.CHANNEL0 = EVSYS_CHANNEL0_PORTA_PIN0_gc + SYMBOL_PIN_NUMBER(peek_step);
+    } else {
+        EVSYS.CHANNEL0 = EVSYS_CHANNEL0_OFF_gc;  // No button on this pin
+    }
+    step_start = reaction_now();
+    capture_armed = 1;
+}
+
+/**
+ * Finishes timing a step once the press has been registered
+ *
+ * @param correct Non-zero if the pressed button matched the sequence
+ *
+ * Uses the captured edge when the expected button was pressed, otherwise
+ * the current time. Updates round statistics and the speed bonus.
+ */
+void reaction_step_end(uint8_t correct) {
+    uint32_t end = capture_armed ? reaction_now() : capture_time;
+    capture_armed = 0;
+
+    uint32_t elapsed = end - step_start;
+
+    if (elapsed < round_min) round_min = elapsed;
+    if (elapsed > round_max) round_max = elapsed;
+    round_total += elapsed;
+    round_steps++;
+
+    /* Only correct steps earn speed points */
+    if (correct) {
+        if (elapsed < REACTION_FAST_MS * REACTION_TICKS_PER_MS) {
+            bcd_add(&score, 3);
+        } else if (elapsed < REACTION_MEDIUM_MS * REACTION_TICKS_PER_MS) {
+            bcd_add(&score, 2);
+        } else if (elapsed < REACTION_SLOW_MS * REACTION_TICKS_PER_MS) {
+            bcd_add(&score, 1);
+        }
+    }
+}
+
+/**
+ * Sends the round's reaction statistics via UART and resets them
+ *
+ * Format: "REACTION min: N avg: N max: N us\n"
+ */
+void reaction_round_report(void) {
+    capture_armed = 0;
+
+    if (round_steps) {
+        uart_printf("REACTION min: %lu avg: %lu max: %lu us\n",
+                    ticks_to_us(round_min),
+                    ticks_to_us(round_total / round_steps),
+                    ticks_to_us(round_max));
+    }
+
+    round_steps = 0;
+    round_total = 0;
+    round_min = UINT32_MAX;
+    round_max = 0;
+}
+
+/**
+ * Timer Counter B1 Interrupt Service Routine (input capture mode)
+ *
+ * Handles:
+ * - Capture: latches the first button edge after arming
+ * - Overflow: extends the 16-bit counter
+ *
+ * The capture is processed first; a capture near MAX with an overflow also
+ * pending happened before the wrap and must not include it.
+ */
+ISR(TCB1_INT_vect) {
+    uint8_t flags = TCB1.INTFLAGS;
+
+    if (flags & TCB_CAPT_bm) {
+        uint16_t captured = TCB1.CCMP;  // Reading CCMP clears the flag
+        if (capture_armed) {
+            uint16_t high = capture_overflows;
+            if ((flags & TCB_OVF_bm) && captured < 0x8000) {
+                high++;
+            }
+            capture_time = ((uint32_t)high << 16) | captured;
+            capture_armed = 0;
+        }
+    }
+
+    if (flags & TCB_OVF_bm) {
+        capture_overflows++;
+        TCB1.INTFLAGS = TCB_OVF_bm;
+    }
+}
+
+#endif /* REACTION_MODE */
@@ -0,0 +1,333 @@
+/**
+ * @file replay.c
+ * @brief Deterministic record and replay of player input
+ *
+ * This module makes game sessions reproducible:
+ * - Record mode logs the starting seed and every input event (debounced
+ *   button state, UART key, potentiometer reading) into a small ring
+ *   buffer that is streamed out over UART as the UART queue has room
+ * - Playback mode feeds a captured log back into the input path in place
+ *   of the hardware, so the same session runs again tick for tick
+ *
+ * Event timestamps are 1ms tick deltas from the previous event. A gap
+ * too long for 16 bits is preceded by a WAIT event carrying its upper 16
+ * bits (about 65.5s each), so no delay is clamped. A SYNC
+ * event marks each entry to the INPUT stage, which keeps playback aligned
+ * with the game even when non-input work (such as streaming the log)
+ * takes a different amount of time.
+ *
+ * Streamed format, one record per line:
+ *   #Sssssssss  Seed at the start of a game (hex)
+ *   #Ettttyyvv  Event: ticks, type, value (hex)
+ *   #Dtttttttt  Playback finished, total ticks taken (hex)
+ *
+ * Each main loop pass moves buffered events into the UART transmit queue
+ * only while a whole line fits, so streaming never waits on the UART and
+ * input keeps being sampled. A line takes about 11ms at 9600 baud, far
+ * less than a press and release, so the buffer only fills when events
+ * arrive faster than that for REPLAY_BUFFER_SIZE events in a row. Then
+ * the oldest line is sent on the spot rather than dropping an event; the
+ * wait shows up in the next event's tick delta.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "replay.h"
+#include "timer.h"
+#include "lsfr.h"
+#include "uart.h"
+#include "uart_format.h"
+
+#if REPLAY_MODE != REPLAY_OFF
+
+static uint32_t last_event_tick;    // Tick of the previously logged/applied event
+
+#if REPLAY_MODE == REPLAY_RECORD
+
+// Length of one "#E" line, the most streamed per event
+#define EVENT_LINE_LENGTH 11
+
+static replay_event buffer[REPLAY_BUFFER_SIZE];
+static uint8_t buffer_head;         // Oldest event waiting to be streamed
+static uint8_t buffer_count;        // Events waiting to be streamed
+static uint8_t last_buttons = 0xFF; // Last logged debounced state
+static uint8_t last_adc;            // Last logged potentiometer value
+static uint8_t adc_logged;          // Flag set once an ADC value was logged
+
+/**
+ * Streams the oldest buffered event and removes it from the buffer
+ *
+ * Waits for the UART only if the transmit queue lacks room for the line.
+ */
+static void stream_event(void) {
+    const replay_event *event = &buffer[buffer_head];
+
+    uart_printf("#E%04X%02X%02X\n", event->ticks, event->type, event->value);
+    buffer_head = (buffer_head + 1) % REPLAY_BUFFER_SIZE;
+    buffer_count--;
+}
+
+/**
+ * Stores an event in the record buffer
+ *
+ * A full buffer streams its oldest event first, so no event is dropped.
+ */
+static void append_event(uint16_t ticks, replay_event_type type, uint8_t value) {
+    if (buffer_count == REPLAY_BUFFER_SIZE) {
+        stream_event();
+    }
+    replay_event *event = &buffer[(buffer_head + buffer_count) % REPLAY_BUFFER_SIZE];
+    event->ticks = ticks;
+    event->type = type;
+    event->value = value;
+    buffer_count++;
+}
+
+/**
+ * Appends an event to the record buffer, timestamped since the last one
+ *
+ * @param type Event type
+ * @param value Event payload
+ */
+static void record_event(replay_event_type type, uint8_t value) {
+    uint32_t now = ticks_now();
+    uint32_t elapsed = now - last_event_tick;
+
+    if (elapsed > 0xFFFF) {
+        append_event(elapsed >> 16, EVENT_WAIT, 0);
+    }
+    append_event(elapsed, type, value);
+    last_event_tick = now;
+}
+
+/**
+ * Streams a seed header at the start of each game
+ */
+void replay_start(void) {
+    replay_flush();
+    uart_printf("#S%08lX\n", game.seed);
+}
+
+/**
+ * Logs entry to the INPUT stage
+ */
+void replay_sync(void) {
+    record_event(EVENT_SYNC, 0);
+}
+
+/**
+ * Streams buffered events while the UART queue has room for a whole line
+ *
+ * Called on every main loop pass; never waits for the UART.
+ */
+void replay_poll(void) {
+    while (buffer_count && uart_tx_free() >= EVENT_LINE_LENGTH) {
+        stream_event();
+    }
+}
+
+/**
+ * Streams all buffered events over UART and empties the buffer
+ *
+ * Called between rounds and before each seed header, so the log stays in
+ * order; may wait for the UART.
+ */
+void replay_flush(void) {
+    while (buffer_count) {
+        stream_event();
+    }
+}
+
+/**
+ * Logs changes of the debounced button state
+ *
+ * @param state Debounced button state from the hardware
+ * @return The same state, unchanged
+ */
+uint8_t replay_buttons(uint8_t state) {
+    if (state != last_buttons) {
+        last_buttons = state;
+        record_event(EVENT_BUTTONS, state);
+    }
+    return state;
+}
+
+/**
+ * Logs a UART key at the point it is consumed as a button
+ *
+ * @param key Pin mask set by the UART receive handler (0 if none)
+ * @return The same key, unchanged
+ */
+uint8_t replay_key(uint8_t key) {
+    if (key) {
+        record_event(EVENT_UART, key);
+    }
+    return key;
+}
+
+/**
+ * Logs potentiometer readings that differ from the previous one
+ *
+ * @param value ADC result used to compute the playback delay
+ * @return The same value, unchanged
+ */
+uint8_t replay_adc(uint8_t value) {
+    if (!adc_logged || value != last_adc) {
+        adc_logged = 1;
+        last_adc = value;
+        record_event(EVENT_ADC, value);
+    }
+    return value;
+}
+
+#else /* REPLAY_PLAYBACK */
+
+#include "replay_log.h"
+
+static const replay_event replay_log[] = REPLAY_LOG_EVENTS;
+
+static const replay_event *cursor;  // Next event to apply
+static uint8_t replay_state = 0xFF; // Replayed debounced button state
+static uint8_t replay_pending_key;  // Replayed UART key not yet consumed
+static uint8_t replay_adc_value;    // Replayed potentiometer value
+static uint32_t start_tick;         // Tick when playback began
+static uint8_t finished;            // Flag set once the end was reported
+
+/**
+ * Finds the next event if it has the given type
+ *
+ * @param type Event type consumed at a fixed point in the game
+ * @return The event, or NULL if the log has something else next
+ *
+ * A WAIT ahead of it is skipped: these events are applied when the game
+ * reaches them, not after a delay.
+ */
+static const replay_event *next_event(replay_event_type type) {
+    const replay_event *event = cursor;
+
+    if (!event) {
+        return 0;
+    }
+    if (event->type == EVENT_WAIT) {
+        event++;
+    }
+    return event->type == type ? event : 0;
+}
+
+/**
+ * Loads the recorded seed and rewinds the log on the first game
+ *
+ * Later games continue from the seed the FAIL stage derives, exactly as
+ * they did while recording.
+ */
+void replay_start(void) {
+    if (!cursor) {
+        cursor = replay_log;
+        game.seed = REPLAY_LOG_SEED;
+        start_tick = last_event_tick = ticks_now();
+    }
+}
+
+/**
+ * Consumes a SYNC marker when the game enters the INPUT stage
+ */
+void replay_sync(void) {
+    const replay_event *event = next_event(EVENT_SYNC);
+
+    if (event) {
+        last_event_tick = ticks_now();
+        cursor = event + 1;
+    }
+}
+
+/**
+ * Applies all button and UART events whose time has come
+ *
+ * A WAIT event adds its long delay to the event that follows it.
+ * SYNC and ADC events are left for replay_sync() and replay_adc(), which
+ * consume them at the same point in the game where they were recorded.
+ * Reports the total playback time once the log is exhausted.
+ */
+void replay_poll(void) {
+    if (!cursor) {
+        return;
+    }
+
+    for (;;) {
+        const replay_event *event = cursor;
+        uint32_t wait = 0;
+
+        if (event->type == EVENT_WAIT) {
+            wait = (uint32_t)event->ticks << 16;
+            event++;
+        }
+        if (event->type != EVENT_BUTTONS && event->type != EVENT_UART) {
+            break;
+        }
+        uint32_t now = ticks_now();
+        if (now - last_event_tick < wait + event->ticks) {
+            return;
+        }
+        if (event->type == EVENT_BUTTONS) {
+            replay_state = event->value;
+        } else {
+            replay_pending_key = event->value;
+        }
+        last_event_tick = now;
+        cursor = event + 1;
+    }
+
+    if (cursor->type == EVENT_END && !finished) {
+        finished = 1;
+        uart_printf("#D%08lX\n", ticks_since(start_tick));
+    }
+}
+
+/**
+ * Nothing is streamed during playback
+ */
+void replay_flush(void) {
+}
+
+/**
+ * Substitutes the replayed button state for the hardware state
+ */
+uint8_t replay_buttons(uint8_t state) {
+    (void)state;
+    return replay_state;
+}
+
+/**
+ * Substitutes the replayed UART key for the live one
+ *
+ * A key is handed out once and then cleared, matching how the live
+ * button_active flag is consumed.
+ */
+uint8_t replay_key(uint8_t key) {
+    (void)key;
+    uint8_t replayed = replay_pending_key;
+    replay_pending_key = 0;
+    return replayed;
+}
+
+/**
+ * Substitutes the replayed potentiometer reading
+ *
+ * Consumes the next event if it is an ADC reading; otherwise the previous
+ * reading still applies, since only changes were recorded.
+ */
+uint8_t replay_adc(uint8_t value) {
+    (void)value;
+    const replay_event *event = next_event(EVENT_ADC);
+
+    if (event) {
+        replay_adc_value = event->value;
+        last_event_tick = ticks_now();
+        cursor = event + 1;
+    }
+    return replay_adc_value;
+}
+
+#endif /* REPLAY_MODE */
+
+#endif /* REPLAY_MODE != REPLAY_OFF */
@@ -0,0 +1,106 @@
+/**
+ * @file score.c
+ * @brief Packed BCD score and level counters
+ *
+ * Scores are kept as packed BCD (two digits per byte) and incremented in
+ * place, so the display and UART read decimal digits directly instead of
+ * recomputing them with divides or repeated subtraction on every call.
+ *
+ * score: rounds completed (plus speed bonus in the timed mode)
+ * level: current sequence length, advanced with sequence_length
+ */
+
+#include "score.h"
+
+bcd_counter_t score;
+bcd_counter_t level;
+
+/**
+ * Resets counters for a new game: score 0, level 1
+ */
+void score_reset(void) {
+    for (uint8_t i = 0; i < SCORE_DIGITS / 2; i++) {
+        score.bcd[i] = 0;
+        level.bcd[i] = 0;
+    }
+    level.bcd[0] = 0x01;
+}
+
+/**
+ * Advances the level counter
+ *
+ * Called together with sequence_length++ so both stay in step.
+ */
+void score_level_up(void) {
+    bcd_add(&level, 1);
+}
+
+/**
+ * Adds a small amount to a BCD counter in place
+ *
+ * @param counter Counter to update
+ * @param amount Value to add (0-9)
+ *
+ * Adds to the lowest digit and ripples the carry upward, stopping as soon
+ * as no carry remains. A carry out of the top digit pair saturates the
+ * counter at all nines (999999) rather than wrapping to zero.
+ */
+void bcd_add(bcd_counter_t *counter, uint8_t amount) {
+    uint8_t i;
+    for (i = 0; i < SCORE_DIGITS / 2 && amount; i++) {
+        uint8_t low = (counter->bcd[i] & 0x0F) + amount;
+        uint8_t high = counter->bcd[i] >> 4;
+
+        amount = 0;
+        if (low > 9) {
+            low -= 10;
+            high++;
+        }
+        if (high > 9) {
+            high -= 10;
+            amount = 1;  // Carry into the next digit pair
+        }
+        counter->bcd[i] = (high << 4) | low;
+    }
+
+    if (amount) {
+        for (i = 0; i < SCORE_DIGITS / 2; i++) {
+            counter->bcd[i] = 0x99;  // Overflowed: hold at the maximum
+        }
+    }
+}
+
+/**
+ * Reads a single decimal digit from a BCD counter
+ *
+ * @param counter Counter to read
+ * @param index Digit position, 0 = ones
+ * @return Digit value (0-9)
+ */
+uint8_t bcd_digit(const bcd_counter_t *counter, uint8_t index) {
+    uint8_t pair = counter->bcd[index >> 1];
+    return (index & 1) ? (pair >> 4) : (pair & 0x0F);
+}
+
+/**
+ * Extracts the two lowest digits of a counter for the display
+ *
+ * @param counter Counter to show
+ * @param left_digit Pointer to store tens digit (or blank if leading zero)
+ * @param right_digit Pointer to store ones digit
+ *
+ * The tens digit is blanked (segment index 10) only when it and all higher
+ * digits are zero; larger values show their last two digits.
+ */
+void bcd_display_digits(const bcd_counter_t *counter, uint8_t *left_digit, uint8_t *right_digit) {
+    uint8_t upper = 0;
+    for (uint8_t i = 1; i < SCORE_DIGITS / 2; i++) {
+        upper |= counter->bcd[i];
+    }
+
+    *right_digit = counter->bcd[0] & 0x0F;
+    *left_digit = counter->bcd[0] >> 4;
+    if (*left_digit == 0 && upper == 0) {
+        *left_digit = 10;  // Use 10 (blank) for a leading zero
+    }
+}
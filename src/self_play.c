@@ -0,0 +1,210 @@
+/**
+ * @file self_play.c
+ * @brief Built-in bot for unattended soak and throughput testing
+ *
+ * The bot never reads the game's generator state. When playback starts
+ * it notes the round length; when INPUT begins it copies the round's
+ * start state (endurance_origin()) and steps its own copy through
+ * SEQUENCE() to know each expected symbol. Presses are injected by
+ * setting button_active, exactly as the UART receive handler does, so
+ * they go through check_button_input() and the normal press/release
+ * handling.
+ *
+ * Wrong presses and reaction jitter come from a separate xorshift state,
+ * so the game sequence is unaffected by the bot's choices.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "self_play.h"
+#include "states_m.h"
+#include "input.h"
+#include "timer.h"
+#include "lsfr.h"
+#include "endurance.h"
+#include "uart.h"
+#include "uart_format.h"
+
+#if SELF_PLAY
+
+typedef struct {
+    uint32_t rounds;            // Rounds completed (SUCCESS)
+    uint32_t games;             // Games ended (FAIL)
+    uint32_t presses;           // Presses injected
+    uint16_t errors;            // Deliberately wrong presses
+    uint16_t timing;            // Timing violations
+    uint16_t anomalies;         // State machine anomalies
+} self_play_stats_t;
+
+static self_play_stats_t stats;
+static uint32_t started_at;     // Tick the bot started or was last reported
+
+static uint32_t bot_state;      // Bot's copy of the generator state
+static uint32_t rng = 0x2545F491;  // Jitter and error choices
+static uint16_t round_steps;    // Presses in the current round
+static uint16_t presses_left;   // Presses still to make this round
+static uint8_t wrong_pressed;   // A wrong press was made this round
+
+static uint32_t playback_start; // Tick playback started
+static uint32_t due;            // Tick of the next press
+static uint8_t due_set;         // due is valid
+static uint8_t pending;         // Press injected, not yet consumed
+static uint32_t injected_at;    // Tick of the pending press
+
+/**
+ * Returns the next xorshift32 value for the bot's own choices
+ */
+static uint32_t bot_random(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/**
+ * Fixes the playback delay at its minimum (called after settings load)
+ */
+void self_play_init(void) {
+    playback_delay_override = PLAYBACK_DELAY_MIN;
+    started_at = ticks_now();
+}
+
+/**
+ * Buttons the bot "presses" at START
+ *
+ * @return S1, which resumes an endurance checkpoint when one is offered
+ */
+uint8_t self_play_start_keys(void) {
+    return mapped_array[0].pin;
+}
+
+/**
+ * Notes the start of playback (called before the first note)
+ *
+ * @param steps Notes about to be played
+ */
+void self_play_playback(uint16_t steps) {
+    round_steps = steps;
+    playback_start = ticks_now();
+}
+
+/**
+ * Checks playback timing and starts shadowing the round (INPUT begins)
+ *
+ * Each step is a note and a gap of half the delay each, so playback
+ * must take steps x delay, allowing for loop overhead.
+ */
+void self_play_round_start(void) {
+    const uint32_t elapsed = ticks_since(playback_start);
+    const uint32_t expected = (uint32_t)round_steps * ((playback_delay >> 1) << 1);
+
+    if (elapsed < expected || elapsed > expected + (uint32_t)round_steps * SELF_PLAY_SLACK_MS) {
+        stats.timing++;
+    }
+
+    bot_state = endurance_origin();
+    presses_left = round_steps;
+    wrong_pressed = 0;
+    pending = 0;
+    due_set = 0;
+}
+
+/**
+ * Injects the next press when it is due (called from the main loop)
+ */
+void self_play_poll(void) {
+    if (game.stage != INPUT) {
+        return;
+    }
+
+    if (pending) {
+        if (game.button_active) {
+            return;             // Not consumed yet
+        }
+        pending = 0;
+        if (ticks_since(injected_at) > SELF_PLAY_PICKUP_MS) {
+            stats.timing++;
+        }
+    }
+
+    /* Wait for the previous press to complete, then react */
+    if (game.button != COMPLETE) {
+        due_set = 0;
+        return;
+    }
+    if (!due_set) {
+        uint16_t jitter = bot_random() % (SELF_PLAY_REACTION_MS / 2 + 1);
+        due = ticks_now() + SELF_PLAY_REACTION_MS - SELF_PLAY_REACTION_MS / 4 + jitter;
+        due_set = 1;
+        return;
+    }
+    if (!presses_left || !deadline_reached(due)) {
+        return;
+    }
+
+    uint8_t symbol, bit;
+    SEQUENCE(&bot_state, &symbol, &bit);
+#if SELF_PLAY_ERROR_PERMILLE
+    if (bot_random() % 1000 < SELF_PLAY_ERROR_PERMILLE) {
+        symbol = (symbol + 1 + bot_random() % (SYMBOL_COUNT - 1)) % SYMBOL_COUNT;
+        wrong_pressed = 1;
+        stats.errors++;
+    }
+#endif
+
+    injected_at = ticks_now();
+    pending = 1;
+    due_set = 0;
+    presses_left--;
+    stats.presses++;
+    game.button_active = mapped_array[symbol].pin;
+}
+
+/**
+ * Checks the outcome of a round against the presses made
+ *
+ * @param success Non-zero at SUCCESS, zero at FAIL
+ */
+void self_play_round_end(uint8_t success) {
+    if (success) {
+        stats.rounds++;
+        if (wrong_pressed || presses_left) {
+            stats.anomalies++;
+        }
+    } else {
+        stats.games++;
+        if (!wrong_pressed) {
+            stats.anomalies++;
+        }
+    }
+    wrong_pressed = 0;
+}
+
+/**
+ * Counts a state machine anomaly found by the game loop
+ */
+void self_play_anomaly(void) {
+    stats.anomalies++;
+}
+
+/**
+ * Reports statistics since the last report, then clears them
+ */
+void self_play_report(void) {
+    uint32_t seconds = ticks_since(started_at) / 1000;
+    if (!seconds) {
+        seconds = 1;
+    }
+
+    uart_printf("bot: %lu rounds %lu games %lu presses in %lu s\n",
+                stats.rounds, stats.games, stats.presses, seconds);
+    uart_printf("bot: %lu rounds/h %lu presses/min\n",
+                stats.rounds * 3600 / seconds, stats.presses * 60 / seconds);
+    uart_printf("bot: wrong %u timing %u anomalies %u\n",
+                stats.errors, stats.timing, stats.anomalies);
+
+    stats = (self_play_stats_t){0};
+    started_at = ticks_now();
+}
+
+#endif
@@ -0,0 +1,148 @@
+/**
+ * @file settings.c
+ * @brief Persistent user settings in USERROW with deferred writes
+ *
+ * Octave, brightness, the fixed playback delay, the typeahead window and
+ * the console seed are restored at boot. Anything that changes one of
+ * them calls settings_touch(); settings_poll() in the main loop waits
+ * until no change has been made for SETTINGS_WRITE_DELAY_MS, then
+ * snapshots the live values and programs the bytes that differ from the
+ * stored block in a single erase/write. The write runs in the background
+ * (EEPROM-type NVM does not halt the CPU).
+ *
+ * The seed and delay are also changed by the game itself (the seed after
+ * each FAIL, the delay by a versus leader), so those are saved only as set
+ * with ":seed" and ":delay", which store them in the block directly.
+ */
+
+#include <avr/io.h>
+#include <avr/cpufunc.h>
+#include <util/crc16.h>
+#include "settings.h"
+#include "timer.h"
+#include "buzzer.h"
+#include "display.h"
+#include "lsfr.h"
+#include "replay.h"
+#include "typeahead.h"
+
+#define SETTINGS_NVM ((volatile uint8_t *)USER_SIGNATURES_START)
+
+_Static_assert(sizeof(settings_t) <= USER_SIGNATURES_SIZE, "settings_t does not fit in USERROW");
+
+settings_t settings;
+
+static volatile uint8_t settings_dirty = 0;  // Set by settings_touch()
+static uint8_t settings_pending = 0;         // Change waiting to be written
+static uint32_t settings_changed_at;         // Tick the latest change was seen
+
+/**
+ * Calculates the CRC of a settings block, excluding the CRC field
+ */
+static uint16_t settings_crc(const settings_t *block) {
+    const uint8_t *bytes = (const uint8_t *)block;
+    uint16_t crc = 0;
+
+    for (uint8_t i = 0; i < sizeof(settings_t) - sizeof(block->crc); i++) {
+        crc = _crc_xmodem_update(crc, bytes[i]);
+    }
+    return crc;
+}
+
+/**
+ * Copies the live settings into the SRAM block (seed and delay excepted)
+ *
+ * Builds without typeahead keep the stored window as it is, so a window
+ * set by a typeahead build survives a reflash in between.
+ */
+static void settings_capture(void) {
+    settings.version = SETTINGS_VERSION;
+    settings.octave = frequency;
+    settings.brightness = display_brightness;
+#if TYPEAHEAD_MS
+    settings.early = typeahead_window;
+#endif
+    settings.crc = settings_crc(&settings);
+}
+
+/**
+ * Restores settings from USERROW (called once at boot)
+ *
+ * A block with the wrong version, a bad CRC or out-of-range values
+ * leaves the compiled defaults in place, as does an unset typeahead
+ * window. Replay builds always use the
+ * defaults so a session replays the same on any unit.
+ */
+void settings_load(void) {
+    uint8_t *bytes = (uint8_t *)&settings;
+    for (uint8_t i = 0; i < sizeof(settings_t); i++) {
+        bytes[i] = SETTINGS_NVM[i];
+    }
+
+    if (REPLAY_MODE != REPLAY_PLAYBACK &&
+        settings.version == SETTINGS_VERSION &&
+        settings.crc == settings_crc(&settings) &&
+        settings.octave >= min_frequency && settings.octave <= max_frequency &&
+        settings.brightness <= DISPLAY_BRIGHTNESS_MAX) {
+        frequency = settings.octave;
+        display_brightness = settings.brightness;
+        playback_delay_override = settings.delay;
+#if TYPEAHEAD_MS
+        if (settings.early != SETTINGS_EARLY_UNSET) {
+            typeahead_window = settings.early;
+        }
+#endif
+        if (settings.seed) {
+            game.seed = settings.seed;
+        }
+        return;
+    }
+
+    settings.seed = game.seed;  // Defaults; nothing is written until a change
+    settings.delay = playback_delay_override;
+    settings.early = SETTINGS_EARLY_UNSET;
+    settings_capture();
+}
+
+/**
+ * Marks the settings as changed (safe to call from an ISR)
+ */
+void settings_touch(void) {
+    settings_dirty = 1;
+}
+
+/**
+ * Writes changed settings once they have been left alone for a while
+ *
+ * Every change restarts the wait. Skipped while a previous write is
+ * still in progress. Bytes that already match USERROW are not loaded into
+ * the page buffer, so the erase/write leaves them untouched.
+ */
+void settings_poll(void) {
+    if (settings_dirty) {
+        settings_dirty = 0;
+        settings_pending = 1;
+        settings_changed_at = ticks_now();
+    }
+
+    if (!settings_pending || ticks_since(settings_changed_at) < SETTINGS_WRITE_DELAY_MS ||
+        (NVMCTRL.STATUS & NVMCTRL_EEBUSY_bm)) {
+        return;
+    }
+    settings_pending = 0;
+
+    settings_capture();
+
+    const uint8_t *bytes = (const uint8_t *)&settings;
+    uint8_t changed = 0;
+    for (uint8_t i = 0; i < sizeof(settings_t); i++) {
+        if (SETTINGS_NVM[i] != bytes[i]) {
+            SETTINGS_NVM[i] = bytes[i];  // Loads the page buffer
+            changed = 1;
+        }
+    }
+
+    if (changed) {
+        _PROTECTED_WRITE_SPM(NVMCTRL.CTRLA, NVMCTRL_CMD_PAGEERASEWRITE_gc);
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ * @file stack.c
+ * @brief Stack painting and high-water mark measurement
+ *
+ * At startup, before main() runs, all SRAM between the end of static data
+ * (.data/.bss) and the top of RAM is filled with STACK_CANARY. The stack
+ * grows down from RAMEND and overwrites the pattern as it is used, so the
+ * number of bytes still holding the pattern gives the worst-case headroom
+ * seen so far, including nested ISRs.
+ *
+ * Memory layout (ATtiny1626, 2KB SRAM):
+ * RAMSTART | .data | .bss | painted free RAM ... | stack <- RAMEND
+ */
+
+#include <avr/io.h>
+#include "stack.h"
+#include "uart_format.h"
+
+/* Symbols provided by the linker script */
+extern uint8_t _end;     // First byte after .bss/.noinit
+extern uint8_t __stack;  // Initial stack pointer (top of RAM)
+
+volatile uint8_t stack_report_requested = 0;
+
+/**
+ * Paints free SRAM with the canary pattern
+ *
+ * Placed in .init3 so it runs after the startup code has cleared r1 and set
+ * the stack pointer (.init2) but before main() has pushed anything. Declared
+ * naked since there is no frame to set up and nothing to return to; control
+ * falls through into the next init section.
+ */
+void stack_paint(void) __attribute__((naked, used, section(".init3")));
+void stack_paint(void) {
+    uint8_t *p = &_end;
+
+    while (p <= &__stack) {
+        *p++ = STACK_CANARY;
+    }
+}
+
+/**
+ * Counts painted bytes that have never been overwritten
+ *
+ * @return Smallest amount of free SRAM seen since reset, in bytes
+ *
+ * Scans upward from the end of static data until the first byte that no
+ * longer holds the canary.
+ */
+uint16_t stack_unused(void) {
+    const uint8_t *p = &_end;
+    uint16_t count = 0;
+
+    while (p <= &__stack && *p == STACK_CANARY) {
+        p++;
+        count++;
+    }
+    return count;
+}
+
+/**
+ * Returns the deepest stack usage seen since reset
+ *
+ * @return Peak stack depth in bytes
+ */
+uint16_t stack_peak(void) {
+    return (uint16_t)(&__stack - &_end) + 1 - stack_unused();
+}
+
+/**
+ * Returns SRAM taken by .data and .bss
+ *
+ * @return Static SRAM usage in bytes
+ */
+uint16_t static_ram_used(void) {
+    return (uint16_t)&_end - RAMSTART;
+}
+
+/**
+ * Sends a memory usage report via UART
+ *
+ * Format: "RAM static: N stack peak: N free: N\n" (bytes)
+ */
+void stack_report(void) {
+    stack_report_requested = 0;
+
+    uart_printf("RAM static: %u stack peak: %u free: %u\n",
+                static_ram_used(), stack_peak(), stack_unused());
+}
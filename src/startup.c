@@ -0,0 +1,126 @@
+/**
+ * @file startup.c
+ * @brief Reset-to-first-tone timing (-DSTARTUP_TRACE=1)
+ *
+ * Stamps are the 1ms tick count plus the TCB0 count within the tick, so
+ * taking one costs a few cycles and no division; they are converted to
+ * microseconds only for the report. Init runs with interrupts disabled,
+ * where the tick count does not advance, so a pending TCB0 flag is
+ * counted as one extra tick. Init must therefore finish within 2ms,
+ * which it does by a wide margin.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include "startup.h"
+#include "timer.h"
+#include "clock.h"
+#include "uart_format.h"
+
+#if STARTUP_TRACE
+
+typedef struct {
+    uint32_t ticks;   // Whole 1ms ticks
+    uint16_t count;   // TCB0 count within the tick
+} startup_time_t;
+
+static startup_time_t stamps[STARTUP_STAGE_COUNT];
+
+static const char name_clock[] PROGMEM = "clock";
+static const char name_timers[] PROGMEM = "timers";
+static const char name_adc[] PROGMEM = "adc";
+static const char name_buttons[] PROGMEM = "buttons";
+static const char name_irq[] PROGMEM = "irq";
+static const char name_spi[] PROGMEM = "spi";
+static const char name_pwm[] PROGMEM = "pwm";
+static const char name_uart[] PROGMEM = "uart";
+static const char name_settings[] PROGMEM = "settings";
+static const char name_main_loop[] PROGMEM = "main loop";
+static const char name_first_tone[] PROGMEM = "first tone";
+
+static const char *const stage_names[STARTUP_STAGE_COUNT] = {
+    [STARTUP_CLOCK] = name_clock,
+    [STARTUP_TIMERS] = name_timers,
+    [STARTUP_ADC] = name_adc,
+    [STARTUP_BUTTONS] = name_buttons,
+    [STARTUP_IRQ] = name_irq,
+    [STARTUP_SPI] = name_spi,
+    [STARTUP_PWM] = name_pwm,
+    [STARTUP_UART] = name_uart,
+    [STARTUP_SETTINGS] = name_settings,
+    [STARTUP_MAIN_LOOP] = name_main_loop,
+    [STARTUP_FIRST_TONE] = name_first_tone
+};
+
+/* Fuse start-up delay in ms for each FUSE.SYSCFG1 SUT setting */
+static const uint8_t sut_ms[8] = {0, 1, 2, 4, 8, 16, 32, 64};
+
+/**
+ * Records the time at which an init stage finished
+ *
+ * @param stage Stage just completed
+ */
+void startup_stamp(startup_stage_t stage) {
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t count = TCB0.CNT;
+    uint32_t ticks = ticks_now();
+    if ((TCB0.INTFLAGS & TCB_CAPT_bm) && count < (TIMER_TICK_CCMP >> 1)) {
+        ticks++;  // Wrapped, but the tick has not been counted yet
+    }
+    SREG = sreg;
+
+    stamps[stage].ticks = ticks;
+    stamps[stage].count = count;
+}
+
+/**
+ * Converts a stamp to microseconds since TCB0 started
+ */
+static uint32_t stamp_us(const startup_time_t *stamp) {
+    uint32_t cycles = (uint32_t)stamp->count * TIMER_TCB_DIV;
+    return stamp->ticks * 1000 + cycles * 1000 / (F_CPU / 1000);
+}
+
+/* Progress of the one-off report */
+static uint8_t first_tone_seen = 0;
+static uint8_t reported = 0;
+
+/**
+ * Stamps the first audible note (called after each note starts)
+ */
+void startup_first_tone(void) {
+    if (!first_tone_seen) {
+        first_tone_seen = 1;
+        startup_stamp(STARTUP_FIRST_TONE);
+    }
+}
+
+/**
+ * Reports the start-up times once the first note has played
+ *
+ * Called after each playback, before INPUT, so the report stretches
+ * neither the notes nor the reaction timing; only the first call after
+ * the first note prints.
+ */
+void startup_report(void) {
+    if (!first_tone_seen || reported) {
+        return;
+    }
+    reported = 1;
+
+    const uint16_t fuse_ms = sut_ms[(FUSE.SYSCFG1 & FUSE_SUT_gm) >> FUSE_SUT_gp];
+    uint32_t previous = 0;
+
+    uart_printf("startup: fuse delay %u ms\n", fuse_ms);
+    for (uint8_t i = 0; i < STARTUP_STAGE_COUNT; i++) {
+        uint32_t at = stamp_us(&stamps[i]);
+        uart_printf("startup: %S at %lu us (+%lu)\n", stage_names[i], at, at - previous);
+        previous = at;
+    }
+    uart_printf("startup: reset to first tone %lu us\n",
+                (uint32_t)fuse_ms * 1000 + stamp_us(&stamps[STARTUP_FIRST_TONE]));
+}
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * @file tempo.c
+ * @brief Level-based tempo curves (-DTEMPO_CURVE=n)
+ *
+ * The per-level factors are constant expressions evaluated by the
+ * compiler, so the table costs TEMPO_LEVELS bytes of flash and each
+ * round's lookup is a table read, a multiply and a shift, with no
+ * division at run time.
+ *
+ * Factors are stored as (Q8 - 1), so 255 is exactly 1.0 and the scaled
+ * delay is (base * (factor + 1)) >> 8.
+ */
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include "tempo.h"
+
+#if TEMPO_CURVE
+
+#if TEMPO_CURVE == TEMPO_LINEAR
+#define TEMPO_CURVE_Q8(i) (256 - (i) * TEMPO_LINEAR_STEP)
+#elif TEMPO_CURVE == TEMPO_EXPONENTIAL
+/* Exact halvings every TEMPO_HALF_LEVELS, linear in between */
+#define TEMPO_HALVED(i) (256 >> ((i) / TEMPO_HALF_LEVELS))
+#define TEMPO_CURVE_Q8(i) \
+    (TEMPO_HALVED(i) - TEMPO_HALVED(i) * ((i) % TEMPO_HALF_LEVELS) / (2 * TEMPO_HALF_LEVELS))
+#elif TEMPO_CURVE == TEMPO_STEPPED
+#define TEMPO_CURVE_Q8(i) (256 - ((i) / TEMPO_STEP_LEVELS) * 32)
+#else
+#error "TEMPO_CURVE must be 0 to 3"
+#endif
+
+/* Factor for level index i (level i + 1), limited by the floor */
+#define TEMPO_Q8(i) \
+    (TEMPO_CURVE_Q8(i) > TEMPO_FLOOR_Q8 ? TEMPO_CURVE_Q8(i) : TEMPO_FLOOR_Q8)
+#define TEMPO_ENTRY(i) ((uint8_t)(TEMPO_Q8(i) - 1))
+#define TEMPO_ROW(i)                                                      \
+    TEMPO_ENTRY(i), TEMPO_ENTRY(i + 1), TEMPO_ENTRY(i + 2), TEMPO_ENTRY(i + 3), \
+    TEMPO_ENTRY(i + 4), TEMPO_ENTRY(i + 5), TEMPO_ENTRY(i + 6), TEMPO_ENTRY(i + 7)
+
+static const uint8_t tempo_table[TEMPO_LEVELS] PROGMEM = {
+    TEMPO_ROW(0), TEMPO_ROW(8), TEMPO_ROW(16), TEMPO_ROW(24)
+};
+
+/**
+ * Scales the base delay for the current level
+ *
+ * @param delay Base delay from the pot or console, in ms
+ * @param sequence_length Current level (1 for the first round)
+ * @return Delay for this round, never below twice TEMPO_MIN_GAP_MS
+ */
+uint16_t tempo_scale(uint16_t delay, uint16_t sequence_length) {
+    uint16_t index = sequence_length ? sequence_length - 1 : 0;
+    if (index >= TEMPO_LEVELS) {
+        index = TEMPO_LEVELS - 1;
+    }
+
+    uint8_t factor = pgm_read_byte(&tempo_table[index]);
+    uint16_t scaled = ((uint32_t)delay * (factor + 1)) >> 8;
+
+    if (scaled < 2 * TEMPO_MIN_GAP_MS) {
+        scaled = 2 * TEMPO_MIN_GAP_MS;
+    }
+    return scaled;
+}
+
+#endif
@@ -3,6 +3,7 @@
  * @brief Implementation of timing and delay functions
  * 
  * This module handles:
+ * - Monotonic 32-bit millisecond time base
  * - Variable delay calculations based on ADC input
  * - Timer interrupt handling
  * - Precise delay generation for game timing
@@ -16,46 +17,103 @@
 #include "uart.h"
 #include "input.h"
 #include "spi.h"
+#include "replay.h"
+#include "reaction.h"
+#include "typeahead.h"
+#include "irq.h"
+#include "clock_governor.h"
+
+/* Monotonic 1ms tick count, only written by the TCB0 ISR */
+static volatile uint32_t tick_count = 0;
+
+/* Current playback delay in ms, from the pot or the override */
+volatile uint16_t playback_delay;
+
+/* Fixed playback delay set from the console, 0 to follow the pot */
+uint16_t playback_delay_override = 0;
+
+/**
+ * Returns the current tick count without tearing
+ * 
+ * @return Milliseconds since reset (wraps after ~49 days)
+ * 
+ * The 32-bit count is read as four bytes, so the TCB0 ISR can update
+ * it part way through a read. The value is read twice and the read
+ * repeated until both agree; interrupts are never disabled. A torn
+ * first read can only equal the second read if the bytes it took
+ * before the update did not change, in which case it is correct.
+ * scripts/test_ticks.py runs this function on the host with a tick
+ * injected between the byte loads.
+ */
+uint32_t ticks_now(void) {
+    uint32_t first, second;
+    do {
+        first = tick_count;
+        second = tick_count;
+    } while (first != second);
+    return first;
+}
+
+/**
+ * Busy-waits for a number of ticks
+ * 
+ * @param duration Ticks to wait
+ * 
+ * Presses made while waiting are queued in typeahead mode. The wait runs
+ * at the idle clock level; the deadline is set before the switch.
+ */
+static void wait_ticks(uint16_t duration) {
+    const uint32_t deadline = ticks_now() + duration;
+    clock_set(CLOCK_IDLE);
+    while (!deadline_reached(deadline)) {
+        typeahead_poll();  // Queue early presses during playback/feedback
+    }
+    clock_set(CLOCK_ACTIVE);
+}
 
 /**
  * Calculates playback delay based on potentiometer reading
  * 
  * Process:
- * 1. Triggers immediate ADC conversion
- * 2. Checks for ADC result ready
+ * 1. Discards any older result and starts a conversion
+ * 2. Waits for it to finish (tens of us)
  * 3. Reads ADC result
  * 4. Calculates delay using formula:
  *    delay = (2000 + (56 * adc_result) - adc_result) >> 3
+ * 5. Applies the console override instead, if one is set
+ *
+ * The pot is sampled now, not one round ago. The conversion adc_init()
+ * primes only settles the reference; its result is discarded here.
  */
 void calculate_playback_delay(void) {
-    /* Start ADC conversion */
+    while (ADC0.STATUS & ADC_ADCBUSY_bm);  // Let the priming conversion end
+    ADC0.INTFLAGS = ADC_RESRDY_bm;          // Discard its result
+
+    /* Convert and wait for the result */
     ADC0.COMMAND |= ADC_START_IMMEDIATE_gc;
+    while (!(ADC0.INTFLAGS & ADC_RESRDY_bm));
 
-    /* Check if conversion complete */
-    adc_ready_flag = ADC0.INTFLAGS & ADC_RESRDY_bm; 
+    /* Read and process ADC result */
+    uint8_t adc_result = replay_adc(ADC0.RESULT);
+    ADC0.INTFLAGS = ADC_RESRDY_bm;  // Clear ready flag
 
-    if (adc_ready_flag) {
-        /* Read and process ADC result */
-        uint8_t adc_result = ADC0.RESULT;
-        ADC0.INTFLAGS = ADC_RESRDY_bm;  // Clear ready flag
+    /* Calculate delay with scaling */
+    playback_delay = (2000 + (56 * adc_result) - adc_result) >> 3;
 
-        /* Calculate delay with scaling */
-        playback_delay = (2000 + (56 * adc_result) - adc_result) >> 3;
+    if (playback_delay_override) {
+        playback_delay = playback_delay_override;
     }
 }
 
 /**
  * Implements a full-duration delay
  * 
- * Uses playback_timer incremented by timer interrupt
+ * Uses the tick count incremented by timer interrupt
  * to create precise delays for game timing.
- * Blocks until playback_timer reaches playback_delay.
+ * Blocks until playback_delay ticks have passed.
  */
 void delay(void) {
-    playback_timer = 0;
-    while (playback_timer < playback_delay) {
-        /* Wait for timer interrupt to increment counter */
-    } 
+    wait_ticks(playback_delay);
 }
 
 /**
@@ -66,20 +124,42 @@ void delay(void) {
  * Used for creating gaps between sequence elements.
  */
 void half_of_delay(void) {
-    playback_timer = 0;
-    while (playback_timer < (playback_delay >> 1)) {
-        /* Wait for timer interrupt to increment counter */
-    } 
+    wait_ticks(playback_delay >> 1);
 }
 
 /**
  * Timer Counter B0 Interrupt Service Routine
  * 
  * Triggered by TCB0 match/capture event
- * Increments playback_timer for delay timing
+ * Increments the monotonic tick count used for delays,
+ * deadlines and event timestamps
  * Called every 1ms based on TCB0 configuration
+ *
+ * In the timed game mode TCB1 is used for input capture, so the
+ * 5ms debounce and display tasks are run here on every fifth tick.
+ *
+ * Also dims the display: each digit is blanked (DISP EN high) once
+ * it has been lit for display_brightness ticks of its 5ms slot.
+ *
+ * Runs at interrupt level 1 (irq.h), preempting the other handlers.
  */
 ISR(TCB0_INT_vect) {
-    playback_timer++;               // Increment timer counter
+    irq_latency_sample(IRQ_TCB0, TCB0.CNT);  // Counts since the flag was set
+    tick_count++;                   // Advance monotonic time base
+
+    if (display_brightness < DISPLAY_BRIGHTNESS_MAX &&
+        ++display_lit_ticks >= display_brightness) {
+        PORTB.OUTSET = PIN1_bm;     // Blank display for rest of slot
+    }
+
+#if REACTION_MODE
+    static uint8_t tick_divider = 0;
+    if (++tick_divider == 5) {
+        tick_divider = 0;
+        pb_debounce();              // Update button debouncing
+        spi_write();                // Update display via SPI
+    }
+#endif
+    irq_done_sample(IRQ_TCB0, TCB0.CNT);     // Counts to the end of the work
     TCB0.INTFLAGS = TCB_CAPT_bm;   // Clear interrupt flag
 }
\ No newline at end of file
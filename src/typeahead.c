@@ -0,0 +1,124 @@
+/**
+ * @file typeahead.c
+ * @brief Queues presses made before the INPUT stage for skilled players
+ *
+ * Playback and the SUCCESS pattern run in blocking delays, so the main loop
+ * does not see presses made then and the UART handler drops keys outside
+ * INPUT. In typeahead mode:
+ * 1. The delay loops call typeahead_poll(), which detects button edges and
+ *    collects UART keys while the game is playing back or celebrating
+ * 2. Each press is queued with its tick timestamp
+ * 3. When INPUT begins, presses older than the early-input window are
+ *    dropped; the rest are handed to check_button_input() in order,
+ *    ahead of live presses, which queue behind them
+ *
+ * Queued presses are treated like UART keys: they are already released,
+ * so each completes after the usual half-delay of feedback. They earn no
+ * reaction-time bonus.
+ */
+
+#include <avr/io.h>
+#include "typeahead.h"
+#include "input.h"
+#include "timer.h"
+#include "replay.h"
+#include "states_m.h"
+
+#if TYPEAHEAD_MS
+
+uint16_t typeahead_window = TYPEAHEAD_MS;  // Early-input window in ms
+
+/* Press queue, only used from the main loop */
+static uint8_t queue_pins[TYPEAHEAD_SIZE];     // Pin mask of one button
+static uint32_t queue_ticks[TYPEAHEAD_SIZE];   // Tick the press was seen
+static uint8_t queue_head;
+static uint8_t queue_tail;
+
+/**
+ * Returns non-zero while presses should be queued rather than dropped
+ *
+ * Also called from the UART receive handler to accept game keys.
+ */
+uint8_t typeahead_accepting(void) {
+    return typeahead_window && (game.stage == START_SEQUENCE || game.stage == SUCCESS);
+}
+
+/**
+ * Queues each button in a pin mask, in symbol order
+ *
+ * @param pins Pin mask of pressed buttons
+ */
+static void enqueue(uint8_t pins) {
+    const uint32_t now = ticks_now();
+
+    for (uint8_t i = 0; i < SYMBOL_COUNT; i++) {
+        if (pins & mapped_array[i].pin) {
+            queue_pins[queue_head] = mapped_array[i].pin;
+            queue_ticks[queue_head] = now;
+            queue_head = (queue_head + 1) & (TYPEAHEAD_SIZE - 1);
+            if (queue_head == queue_tail) {
+                queue_tail = (queue_tail + 1) & (TYPEAHEAD_SIZE - 1);  // Drop oldest
+            }
+        }
+    }
+}
+
+/**
+ * Collects early presses (called from the delay loops)
+ */
+void typeahead_poll(void) {
+    if (!typeahead_accepting()) {
+        return;
+    }
+
+    check_edge();
+    uint8_t pins = pb_falling | replay_key(game.button_active);
+    game.button_active = 0;
+
+    if (pins) {
+        enqueue(pins);
+    }
+}
+
+/**
+ * Drops queued presses outside the early-input window as INPUT begins
+ */
+void typeahead_begin(void) {
+    const uint32_t now = ticks_now();
+
+    while (queue_tail != queue_head &&
+           now - queue_ticks[queue_tail] > typeahead_window) {
+        queue_tail = (queue_tail + 1) & (TYPEAHEAD_SIZE - 1);
+    }
+}
+
+/**
+ * Substitutes the oldest queued press for the live ones
+ *
+ * @param pressed Live press mask; replaced by a queued press if any
+ * @return Non-zero if *pressed now holds a queued press
+ *
+ * Live presses made while the queue is draining are queued behind it,
+ * so presses are always checked in the order they were made.
+ */
+uint8_t typeahead_next(uint8_t *pressed) {
+    if (queue_tail == queue_head) {
+        return 0;
+    }
+
+    if (*pressed) {
+        enqueue(*pressed);
+    }
+    *pressed = queue_pins[queue_tail];
+    queue_tail = (queue_tail + 1) & (TYPEAHEAD_SIZE - 1);
+    return 1;
+}
+
+/**
+ * Empties the queue at the start of a game
+ */
+void typeahead_clear(void) {
+    queue_tail = queue_head;
+}
+
+#endif /* TYPEAHEAD_MS */
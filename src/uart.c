@@ -6,6 +6,7 @@
  * - Serial communication for game input
  * - Character echo and name entry
  * - Score reporting
+ * - Queued, interrupt-driven transmission
  * - Button mapping from keyboard input
  */
 
@@ -15,13 +16,26 @@
 #include "states_m.h"
 #include "uart.h"
 #include "display.h"
+#include "stack.h"
+#include "score.h"
+#include "console.h"
+#include "link.h"
+#include "typeahead.h"
+#include "symbols.h"
+#include "settings.h"
+#include "game.h"
 
 /* Global state variables */
-buttons button;                    // Current button state
-simon_stage stage;                // Current game stage
-volatile uint8_t button_active;   // Flag for active button press
 volatile uint8_t reading_name;    // Flag for name entry mode
 volatile uint8_t name_complete;   // Flag for completed name entry
+static volatile uint8_t tx_sent;  // Set once anything has been transmitted
+
+/* Transmit queue, emptied by the data register empty interrupt */
+static volatile uint8_t tx_queue[UART_TX_SIZE];
+static volatile uint8_t tx_head;  // Next free slot
+static volatile uint8_t tx_tail;  // Next byte to send
+
+#define TX_NEXT(i) (((i) + 1) & (UART_TX_SIZE - 1))
 
 /**
  * USART Receive Complete Interrupt Handler
@@ -37,6 +51,16 @@ volatile uint8_t name_complete;   // Flag for completed name entry
  *    '2' or 'w' -> S2     '.' or 'l' -> Decrease frequency
  *    '3' or 'e' -> S3
  *    '4' or 'r' -> S4
+ *    '5'-'8' or 't'/'y'/'u'/'i' -> S5-S8, with SYMBOL_COUNT > 4
+ *    Keys past SYMBOL_COUNT are ignored.
+ *
+ * 3. Versus mode link messages (header byte with the high bit set and
+ *    its payload bytes), queued for link.c
+ * 
+ * 4. Diagnostics (any state):
+ *    'm' -> Request a RAM/stack usage report
+ *    ':' -> Open a console command line (see console.c); the rest
+ *           of the line is queued for the main loop
  * 
  * Note: A buffer implementation would be more robust for name entry,
  * but current implementation uses direct echo for simplicity.
@@ -44,6 +68,13 @@ volatile uint8_t name_complete;   // Flag for completed name entry
 ISR(USART0_RXC_vect) {
     char rx_data = USART0.RXDATAL;
 
+#if VERSUS_MODE
+    /* Link messages take priority; peer text is dropped once linked */
+    if (link_receive(rx_data)) {
+        return;
+    }
+#endif
+
     /* Handle name entry mode */
     if (reading_name) {
         if (rx_data == '\n') {
@@ -56,62 +87,173 @@ ISR(USART0_RXC_vect) {
         return;
     }
 
-    /* Process game input during INPUT state */
-    if (stage == INPUT) {
+    /* Queue console command lines, bypassing the game keymap */
+    if (console_active || rx_data == CONSOLE_PROMPT) {
+        console_active = 1;
+        console_receive(rx_data);
+        return;
+    }
+
+    /* Handle diagnostic requests; the report is sent from the main loop */
+    if (rx_data == 'm') {
+        stack_report_requested = 1;
+        return;
+    }
+
+    /* Process game input during INPUT state, or queue it for typeahead */
+    if (game.stage == INPUT || typeahead_accepting()) {
         switch (rx_data) {
         /* Button 1 mappings */
         case '1':
         case 'q':
-            button_active = PIN4_bm;
+            game.button_active = PIN4_bm;
             break;
         
         /* Button 2 mappings */
         case '2':
         case 'w':
-            button_active = PIN5_bm;
+            game.button_active = PIN5_bm;
             break;
             
+#if SYMBOL_COUNT > 2
         /* Button 3 mappings */
         case '3':
         case 'e':
-            button_active = PIN6_bm;
+            game.button_active = PIN6_bm;
             break;
+#endif
             
+#if SYMBOL_COUNT > 3
         /* Button 4 mappings */
         case '4':
         case 'r':
-            button_active = PIN7_bm;
+            game.button_active = PIN7_bm;
+            break;
+#endif
+
+#if SYMBOL_COUNT > 4
+        /* Extra symbol mappings (symbols.h) */
+        case '5':
+        case 't':
+            game.button_active = SYMBOL_PIN(4);
+            break;
+#endif
+#if SYMBOL_COUNT > 5
+        case '6':
+        case 'y':
+            game.button_active = SYMBOL_PIN(5);
+            break;
+#endif
+#if SYMBOL_COUNT > 6
+        case '7':
+        case 'u':
+            game.button_active = SYMBOL_PIN(6);
+            break;
+#endif
+#if SYMBOL_COUNT > 7
+        case '8':
+        case 'i':
+            game.button_active = SYMBOL_PIN(7);
             break;
+#endif
             
         /* Frequency control mappings */
         case ',':
         case 'k':
             increase_frequency();
+            settings_touch();
             break;
         case '.':
         case 'l':
             decrease_frequency();
+            settings_touch();
             break;
             
         /* Invalid input handling */
         default:
-            button_active = 0;
+            game.button_active = 0;
             break;
         }
     }
 }
 
 /**
- * Transmits a single character via UART
+ * Moves the oldest queued byte into the data register
+ *
+ * Call with interrupts disabled (or from the DRE interrupt) and the data
+ * register empty. Disables the DRE interrupt once the queue is empty.
+ */
+static void tx_next(void) {
+    if (tx_tail == tx_head) {
+        USART0.CTRLA &= ~USART_DREIE_bm;
+        return;
+    }
+    USART0.STATUS = USART_TXCIF_bm;  // Set again once this frame is out
+    USART0.TXDATAL = tx_queue[tx_tail];
+    tx_tail = TX_NEXT(tx_tail);
+}
+
+/**
+ * USART Data Register Empty Interrupt Handler
+ *
+ * Sends the queued bytes one at a time.
+ */
+ISR(USART0_DRE_vect) {
+    tx_next();
+}
+
+/**
+ * Queues a single character for transmission via UART
  * 
  * @param c Character to transmit
  * 
- * Waits for transmit buffer to be empty before sending
+ * Returns at once unless the queue is full. A full queue is drained by
+ * hand, one byte per free data register, so this also works from an
+ * interrupt handler or with interrupts disabled.
  */
 void uart_putc(uint8_t c) {
-    while (!(USART0.STATUS & USART_DREIF_bm))
-        ;  // Wait for data register empty
-    USART0.TXDATAL = c;
+    for (;;) {
+        uint8_t sreg = SREG;
+        cli();
+        const uint8_t next = TX_NEXT(tx_head);
+        if (next != tx_tail) {
+            tx_queue[tx_head] = c;
+            tx_head = next;
+            tx_sent = 1;
+            USART0.CTRLA |= USART_DREIE_bm;
+            SREG = sreg;
+            return;
+        }
+        if (USART0.STATUS & USART_DREIF_bm) {
+            tx_next();   // Queue full: make room without the interrupt
+        }
+        SREG = sreg;
+    }
+}
+
+/**
+ * Number of characters that can be queued without waiting
+ */
+uint8_t uart_tx_free(void) {
+    return (uint8_t)(tx_tail - tx_head - 1) & (UART_TX_SIZE - 1);
+}
+
+/**
+ * Non-zero when nothing is left to transmit
+ */
+uint8_t uart_tx_idle(void) {
+    return tx_tail == tx_head && (!tx_sent || (USART0.STATUS & USART_TXCIF_bm));
+}
+
+/**
+ * Waits until the queue is empty and the last character has left the
+ * shift register
+ *
+ * Used before the baud rate changes (clock governor) and before a reset.
+ */
+void uart_flush(void) {
+    while (!uart_tx_idle())
+        ;
 }
 
 /**
@@ -128,42 +270,22 @@ void uart_puts(char *string) {
 }
 
 /**
- * Converts and sends a score value as ASCII digits
- * 
- * @param score Score value to send (0-65535)
- * 
- * Algorithm:
- * 1. Special case for zero
- * 2. Extract digits by repeated division by 10
- * 3. Store digits in reverse order
- * 4. Send digits in correct order
- * 
- * Handles scores of any length up to 16-bit value
+ * Sends a BCD score counter as ASCII digits
+ *
+ * @param counter Packed BCD counter to send
+ *
+ * Digits are read straight from the counter, most significant first,
+ * with leading zeros suppressed (zero is sent as "0").
  */
-void send_score(uint16_t score) {
-    char score_str[6];           // Buffer for up to 5 digits plus null
-    uint8_t idx = 0;
-    
-    /* Handle special case of zero */
-    if (score == 0) {
-        uart_putc('0');
-        return;
-    }
-    
-    /* Extract digits in reverse order */
-    while (score > 0) {
-        uint8_t digit = 0;
-        uint16_t temp = score;
-        while (temp >= 10) {
-            temp -= 10;
-            digit++;
-        }
-        score_str[idx++] = '0' + temp;
-        score = digit;
-    }
-    
-    /* Send digits in correct order */
-    while (idx > 0) {
-        uart_putc(score_str[--idx]);
+void send_score(const bcd_counter_t *counter) {
+    uint8_t index = SCORE_DIGITS - 1;
+
+    /* Skip leading zeros, keeping at least the ones digit */
+    while (index > 0 && bcd_digit(counter, index) == 0) {
+        index--;
     }
-}
\ No newline at end of file
+
+    do {
+        uart_putc('0' + bcd_digit(counter, index));
+    } while (index-- > 0);
+}
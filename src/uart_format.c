@@ -0,0 +1,172 @@
+/**
+ * @file uart_format.c
+ * @brief Lightweight formatted output over UART
+ *
+ * A small printf-like layer on top of uart_putc() that:
+ * - Reads format strings from flash, so messages cost no SRAM
+ * - Formats integers without dividing (powers of ten are subtracted)
+ * - Uses no heap, no buffers beyond a few bytes of stack, and no stdio
+ */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
+#include "uart.h"
+#include "uart_format.h"
+
+/* Powers of ten for decimal conversion, highest first */
+static const uint32_t powers_of_ten[] PROGMEM = {
+    1000000000UL, 100000000UL, 10000000UL, 1000000UL,
+    100000UL, 10000UL, 1000UL, 100UL, 10UL, 1UL
+};
+
+/**
+ * Sends a string stored in flash
+ *
+ * @param string Pointer to a null-terminated string in program memory
+ */
+void uart_puts_P(const char *string) {
+    char c;
+    while ((c = pgm_read_byte(string++))) {
+        uart_putc(c);
+    }
+}
+
+/**
+ * Sends a number with optional padding
+ *
+ * @param value Magnitude to print
+ * @param negative Non-zero to prefix a minus sign
+ * @param hex 0 for decimal, 'x' or 'X' for hexadecimal
+ * @param width Minimum field width including sign
+ * @param pad Padding character, ' ' or '0'
+ *
+ * Digits are generated most significant first into a small buffer so the
+ * field width can be applied before anything is sent.
+ */
+static void put_number(uint32_t value, uint8_t negative, char hex, uint8_t width, char pad) {
+    char digits[10];
+    uint8_t count = 0;
+
+    if (hex) {
+        const char letter = hex - ('x' - 'a');  // 'a' or 'A'
+        for (int8_t shift = 28; shift >= 0; shift -= 4) {
+            uint8_t nibble = (value >> shift) & 0x0F;
+            if (nibble || count) {
+                digits[count++] = nibble < 10 ? '0' + nibble : letter + nibble - 10;
+            }
+        }
+    } else {
+        for (uint8_t i = 0; i < 10; i++) {
+            uint32_t power = pgm_read_dword(&powers_of_ten[i]);
+            char digit = '0';
+            while (value >= power) {
+                value -= power;
+                digit++;
+            }
+            if (digit != '0' || count) {
+                digits[count++] = digit;
+            }
+        }
+    }
+
+    if (count == 0) {
+        digits[count++] = '0';
+    }
+
+    uint8_t length = count + (negative ? 1 : 0);
+
+    if (negative && pad == '0') {
+        uart_putc('-');  // Sign goes before zero padding
+    }
+    while (width > length) {
+        uart_putc(pad);
+        width--;
+    }
+    if (negative && pad != '0') {
+        uart_putc('-');
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        uart_putc(digits[i]);
+    }
+}
+
+/**
+ * Sends formatted output with the format string in flash
+ *
+ * @param format Format string in program memory (see uart_format.h)
+ *
+ * Unknown conversions are sent verbatim, '%' and any flag, width and
+ * length characters included; "%%" sends a single '%'.
+ */
+void uart_printf_P(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+
+    char c;
+    while ((c = pgm_read_byte(format++))) {
+        if (c != '%') {
+            uart_putc(c);
+            continue;
+        }
+
+        /* Parse flags, width and length modifier */
+        char pad = ' ';
+        uint8_t width = 0;
+        uint8_t is_long = 0;
+        const char *spec = format;  // First character after the '%'
+
+        c = pgm_read_byte(format++);
+        if (c == '0') {
+            pad = '0';
+            c = pgm_read_byte(format++);
+        }
+        while (c >= '0' && c <= '9') {
+            width = width * 10 + (c - '0');
+            c = pgm_read_byte(format++);
+        }
+        if (c == 'l') {
+            is_long = 1;
+            c = pgm_read_byte(format++);
+        }
+
+        switch (c) {
+        case 'd':
+        case 'i': {
+            int32_t value = is_long ? va_arg(args, int32_t) : va_arg(args, int);
+            uint8_t negative = value < 0;
+            put_number(negative ? -(uint32_t)value : (uint32_t)value, negative, 0, width, pad);
+            break;
+        }
+        case 'u':
+        case 'x':
+        case 'X': {
+            uint32_t value = is_long ? va_arg(args, uint32_t) : va_arg(args, unsigned int);
+            put_number(value, 0, c == 'u' ? 0 : c, width, pad);
+            break;
+        }
+        case 'c':
+            uart_putc((char)va_arg(args, int));
+            break;
+        case 's':
+            uart_puts(va_arg(args, char *));
+            break;
+        case 'S':
+            uart_puts_P(va_arg(args, const char *));
+            break;
+        case '\0':
+            format--;  // Stray '%' at the end: send what was parsed
+            /* fall through */
+        default:
+            if (c != '%' || format - spec != 1) {
+                uart_putc('%');  // Only "%%" drops it
+            }
+            while (spec != format) {
+                uart_putc(pgm_read_byte(spec++));
+            }
+            break;
+        }
+    }
+
+    va_end(args);
+}